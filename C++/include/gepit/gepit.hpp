@@ -1,7 +1,12 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <vector>
 
 #include <pybind11/pybind11.h>
 #include <pybind11/embed.h>
@@ -17,28 +22,126 @@ enum errorCodes : int32_t
     PythonExceptionErr = -2,
     StdExceptionErr = -3,
     InvalidSessionHandle = -4,
-    PythonObjectInvalid = -5
+    PythonObjectInvalid = -5,
+    InvalidCallSiteHandle = -6,
+    InvalidPipelineHandle = -7,
+    InvalidMappedArrayHandle = -8,
+    InvalidWorkerPoolHandle = -9,
+    // warnings (status stays false)
+    InterpreterConfigIgnored = 1
+};
+
+class BufferPool;
+class EventLoop;
+class IteratorPrefetches;
+class KernelRegistry;
+class Profiler;
+class WatchList;
+
+// most recent Python exception raised by a session call
+// the traceback is only formatted (once) when read_python_error asks for it
+struct PythonErrorRecord
+{
+    pybind11::object type;
+    pybind11::object value;
+    pybind11::object trace;
+    std::optional<std::string> formattedTraceback;
+    // object store key of value handed out by read_python_error, reused until LabVIEW releases it
+    std::optional<uint32_t> valueKey;
 };
 
 // C++ Object to be passed back to LabVIEW between DLL calls
 class Session
 {
 private:
-    std::map<int32_t, pybind11::object> objStore;
-    uint32_t objStoreNextKey;
-    std::mutex objStoreMutex;
+    // stored objects live in reusable slots, so steady-state keep/drop cycles don't allocate
+    // keys combine the slot index with a generation which changes whenever the slot is reused
+    struct ObjectSlot
+    {
+        pybind11::object obj;
+        uint32_t generation;
+    };
+    static constexpr uint32_t objStoreIndexBits = 22;
+    std::vector<ObjectSlot> objStore;
+    std::vector<uint32_t> objStoreFreeSlots;
+    // lookups share the lock, so LabVIEW threads reading objects don't serialize (free-threaded Python has no GIL to do it)
+    std::shared_mutex objStoreMutex;
+    ObjectSlot *findSlot(uint32_t key);
+    // interned Python names of scope variables looked up by LabVIEW
+    std::map<std::string, pybind11::str, std::less<>> internedNames;
+    std::mutex internedNamesMutex;
+    PythonErrorRecord lastError;
+    std::mutex lastErrorMutex;
 
 public:
     const pybind11::dict scope;
+    const std::shared_ptr<BufferPool> pool;
+    const std::shared_ptr<WatchList> watches;
+    const std::shared_ptr<KernelRegistry> kernels;
+    const std::shared_ptr<IteratorPrefetches> prefetches;
+    std::shared_ptr<Profiler> profiler;
+    std::shared_ptr<EventLoop> eventLoop;
+    // guards profiler and eventLoop, which are started, used and stopped from different LabVIEW threads
+    // nothing that waits for the GIL may run while it is held
+    std::mutex backgroundMutex;
+    bool realtimeMode;
     Session();
+    explicit Session(pybind11::dict scope);
+    ~Session();
     uint32_t keepObject(pybind11::object obj);
     pybind11::object getObject(uint32_t key);
     void dropObject(uint32_t key);
     bool isNullObject(uint32_t key);
+    // make room for count more stored objects up front
+    void reserveObjects(uint32_t count);
+    // every stored object with its key
+    std::vector<std::pair<uint32_t, pybind11::object>> storedObjects();
+    // store objects under the keys they had in another session (checkpoint_session), none of their slots may be in use
+    void restoreObjects(std::vector<std::pair<uint32_t, pybind11::object>> objects);
+    pybind11::str internName(std::string_view name);
+    // copy of the most recent Python error, another thread may replace it at any time
+    PythonErrorRecord readLastError();
+    // replaced records are released outside the lock, their tracebacks can keep arbitrary objects alive
+    void writeLastError(PythonErrorRecord record);
+    // keep the formatted traceback with the record, unless the error has been replaced since it was read
+    void cacheFormattedTraceback(pybind11::handle value, std::string traceback);
+    // store key of the exception instance, the same one for every read of the same error while it is still held
+    uint32_t keepLastErrorValue(pybind11::handle value);
+    // join the profiler, event loop and iterator prefetch threads (GIL not held), before the session is deleted or the interpreter finalized
+    // on an error the threads which could not be stopped stay with the session
+    void stopBackgroundThreads();
+    // session whose Python code is running on the calling thread (or nullptr)
+    static Session *active();
 };
 
 typedef Session *SessionHandle, **SessionHandlePtr;
 
+class CallSite;
+typedef CallSite *CallSiteHandle, **CallSiteHandlePtr;
+
+class Pipeline;
+typedef Pipeline *PipelineHandle, **PipelineHandlePtr;
+
+class MappedArray;
+typedef MappedArray *MappedArrayHandle, **MappedArrayHandlePtr;
+
+class WorkerPool;
+typedef WorkerPool *WorkerPoolHandle, **WorkerPoolHandlePtr;
+
+// marks a session as active on this thread while its Python code runs
+// so the embedded gepit module can find it
+class ActiveSessionGuard
+{
+private:
+    Session *previous;
+
+public:
+    explicit ActiveSessionGuard(Session *session);
+    ~ActiveSessionGuard();
+    ActiveSessionGuard(const ActiveSessionGuard &) = delete;
+    ActiveSessionGuard &operator=(const ActiveSessionGuard &) = delete;
+};
+
 enum LVNumericType : uint8_t
 {
     I8_ARRAY = 2,
@@ -55,9 +158,46 @@ enum LVNumericType : uint8_t
     CSG_ARRAY = 13, // not used
     CDB_ARRAY = 14, // not used
     CXT_ARRAY = 15, // not used
-    PYOBJ = 40
+    // bulk attribute exports only: scalars are exchanged through a DBL array, strings through string handles
+    DBL_SCALAR = 20,
+    STRING = 30,
+    PYOBJ = 40,
+    // a 1-D array of DBL waveforms, DBL_WAVEFORM passes element 0 of it on its own (Build Array a single waveform)
+    DBL_WAVEFORM = 50,
+    DBL_WAVEFORM_ARRAY = 51
 };
 
+// how a LabVIEW array argument is presented to Python, carried in the top bits of LVTypeInfo.type
+// e.g. DBL_ARRAY | DLPACK_MODE passes a DLPack producer instead of a numpy.ndarray
+enum LVArgumentMode : uint8_t
+{
+    NUMPY_MODE = 0x00,
+    DLPACK_MODE = 0x40,
+    ARROW_MODE = 0x80,
+    // read-only numpy.ndarray, copied into 64-byte aligned pool scratch when the LabVIEW data isn't aligned
+    ALIGNED_MODE = 0xC0
+};
+constexpr uint8_t LVArgumentModeMask = 0xC0;
+// in the top bit of LVTypeInfo.ndims: an ALIGNED_MODE argument Python may write to, scratch is copied back after a successful call
+constexpr uint8_t LVInOutFlag = 0x80;
+
+inline LVNumericType lvBaseType(LVNumericType type)
+{
+    return static_cast<LVNumericType>(type & ~LVArgumentModeMask);
+}
+inline LVArgumentMode lvArgumentMode(LVNumericType type)
+{
+    return static_cast<LVArgumentMode>(type & LVArgumentModeMask);
+}
+inline uint8_t lvDims(uint8_t ndims)
+{
+    return static_cast<uint8_t>(ndims & ~LVInOutFlag);
+}
+inline bool lvIsInOut(uint8_t ndims)
+{
+    return (ndims & LVInOutFlag) != 0;
+}
+
 enum ImaqImageDataTypes : uint32_t {
     Grayscale_U8 = 0,
     Grayscale_I16 = 1,
@@ -73,7 +213,7 @@ enum ImaqImageDataTypes : uint32_t {
 #ifdef _32_BIT_ENV_
 typedef uint32_t LVVoid_t;
 #else
-typedef uint64_t LVVoid_t
+typedef uint64_t LVVoid_t;
 #endif
 
 // define bitness dependent value types
@@ -93,23 +233,107 @@ typedef struct
 
 typedef LVArray_t<1, LVTypeInfo> **LVArgumentTypeInfoHandle;
 
+typedef LVArray_t<1, LVStrHandle> **LVStrArrayHandle;
+typedef LVArray_t<1, int32_t> **LVI32ArrayHandle;
+typedef LVArray_t<1, double> **LVDblArrayHandle;
+typedef LVArray_t<1, LVBoolean> **LVBooleanArrayHandle;
+
+// LabVIEW timestamp: seconds since 1904-01-01 00:00 UTC plus a binary fraction of a second
+typedef struct
+{
+    uint64_t fraction;
+    int64_t seconds;
+} LVTimestamp;
+
+typedef struct
+{
+    LVTimestamp t0;
+    double dt;
+    LVDblArrayHandle Y;
+    void *attributes; // variant, not converted
+} LVWaveformDBL;
+
+typedef LVArray_t<1, LVWaveformDBL> **LVWaveformDBLArrayHandle;
+
 typedef struct{
     uint64_t pixelPointer;
     int32_t lineWidth, width, height;
     ImaqImageDataTypes type;
 } LVIMAQImage, *LVIMAQImagePtr;
 
+typedef struct{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t returned; // buffers handed back to the pool for reuse
+    uint64_t evicted; // buffers freed because the pool was full
+    uint64_t idleBuffers;
+    uint64_t idleBytes;
+} LVBufferPoolStats, *LVBufferPoolStatsPtr;
+
+typedef struct
+{
+    uint64_t aligned; // ALIGNED_MODE arguments passed without a copy
+    uint64_t copied; // ALIGNED_MODE arguments copied into aligned scratch
+    uint64_t copiedBytes;
+} LVAlignedMarshallingStats, *LVAlignedMarshallingStatsPtr;
+
+typedef struct
+{
+    uint64_t calls;
+    double meanUs;
+    double maxUs;
+    double p99Us;
+    double p999Us;
+} LVLatencyStats, *LVLatencyStatsPtr;
+
+typedef struct
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evicted;
+    uint64_t entries;
+    uint64_t bytes; // estimated size of the cached results
+    uint64_t hashedBytes; // argument bytes hashed to look results up
+} LVMemoStats, *LVMemoStatsPtr;
+
+typedef struct
+{
+    uint32_t chunks;
+    uint32_t threads;
+    uint64_t steals; // chunk ranges taken over from another thread's queue
+    double wallMs;
+    double chunkMs; // summed duration of all chunks, chunkMs / wallMs is the parallelism achieved
+} LVParallelMapStats, *LVParallelMapStatsPtr;
+
+// sub-region of an array argument (up to 3 dimensions) passed as a strided view instead of the whole array
+// zeroed entries select everything: count <= 0 runs to the end of the dimension, step <= 0 is 1
+typedef struct
+{
+    int32_t start[3];
+    int32_t count[3];
+    int32_t step[3];
+    LVBoolean fortranOrder; // present the region with its dimensions reversed (column-major)
+} LVArrayRegion, *LVArrayRegionPtr;
+
+typedef LVArray_t<1, LVArrayRegion> **LVArgumentRegionHandle;
+
 // reset packing
 #ifdef _32_BIT_ENV_
 #pragma pack(pop)
 #endif
 
+// the GIL is released between calls, exports that touch Python objects acquire it on entry
 extern "C"
 {
     GEPIT_EXPORT int32_t initialize_interpreter(LVErrorClusterPtr errorPtr, LVBoolean *alreadyRunningPtr);
+    GEPIT_EXPORT int32_t initialize_interpreter_with_config(LVErrorClusterPtr errorPtr, LVStrArrayHandle preloadModulesHandle, LVStrArrayHandle sysPathAdditionsHandle, LVStrHandle pythonHomeStrHandle, LVBoolean isolated, LVBoolean noSite, LVBoolean *alreadyRunningPtr);
+    GEPIT_EXPORT int32_t interpreter_warmup_status(LVErrorClusterPtr errorPtr, int32_t timeoutMs, LVBoolean *readyPtr, LVStrHandlePtr reportStrHandlePtr);
     GEPIT_EXPORT int32_t finalize_interpreter(LVErrorClusterPtr errorPtr);
     GEPIT_EXPORT int32_t create_session(LVErrorClusterPtr errorPtr, SessionHandlePtr sessionPtr);
     GEPIT_EXPORT int32_t destroy_session(LVErrorClusterPtr errorPtr, SessionHandle session);
+    GEPIT_EXPORT int32_t clone_session(LVErrorClusterPtr errorPtr, SessionHandle session, LVBoolean copyMutableValues, SessionHandlePtr clonePtr);
+    GEPIT_EXPORT int32_t checkpoint_session(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle pathStrHandle, LVBoolean includeObjects, LVStrHandlePtr skippedStrHandlePtr);
+    GEPIT_EXPORT int32_t restore_session(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle pathStrHandle, LVBoolean restoreObjects);
     GEPIT_EXPORT int32_t evaluate_script(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle filePathStrHandle);
     GEPIT_EXPORT int32_t exec_string(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle stringHandle);
     GEPIT_EXPORT int32_t evaluate_string(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle expressionHandle, LVPythonObjRef *returnObjectPtr);
@@ -120,14 +344,86 @@ extern "C"
     GEPIT_EXPORT int32_t cast_py_object_to_int(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, int32_t *returnValuePtr);
     GEPIT_EXPORT int32_t cast_py_object_to_dbl(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, double *returnValuePtr);
     GEPIT_EXPORT int32_t call_function(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef classInstance, LVStrHandle fnNameStrHandle, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVPythonObjRef *returnObjectPtr);
+    GEPIT_EXPORT int32_t call_function_with_regions(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef classInstance, LVStrHandle fnNameStrHandle, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle, LVPythonObjRef *returnObjectPtr);
+    GEPIT_EXPORT int32_t call_function_parallel_map(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle fnNameStrHandle, LVVoid_t inputHandle, LVNumericType inputType, uint8_t ndims, int32_t axis, uint32_t chunkBytes, int32_t nThreads, LVNumericType outputType, uint8_t outputNdims, LVVoid_t *outputHandlePtr, LVParallelMapStatsPtr statsPtr);
+    GEPIT_EXPORT int32_t call_kernel(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle kernelNameStrHandle, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVDblArrayHandle scalarsHandle, double *returnValuePtr);
+    GEPIT_EXPORT int32_t create_call_site(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle fnNameStrHandle, LVStrArrayHandle kwNamesHandle, CallSiteHandlePtr callSitePtr);
+    GEPIT_EXPORT int32_t destroy_call_site(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite);
+    GEPIT_EXPORT int32_t invoke_call_site(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVPythonObjRef classInstance, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVPythonObjRef *returnObjectPtr);
+    GEPIT_EXPORT int32_t invoke_call_site_with_regions(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVPythonObjRef classInstance, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle, LVPythonObjRef *returnObjectPtr);
+    GEPIT_EXPORT int32_t read_call_site_latency(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVBoolean reset, LVLatencyStatsPtr statsPtr);
+    GEPIT_EXPORT int32_t configure_call_site_memo(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, uint64_t maxBytes);
+    GEPIT_EXPORT int32_t read_call_site_memo_stats(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVBoolean reset, LVMemoStatsPtr statsPtr);
+    GEPIT_EXPORT int32_t set_realtime_mode(LVErrorClusterPtr errorPtr, SessionHandle session, LVBoolean enable, uint32_t reserveObjects);
+    GEPIT_EXPORT int32_t gc_collect_budgeted(LVErrorClusterPtr errorPtr, SessionHandle session, double budgetMs, int32_t *generationPtr, int32_t *collectedPtr, double *elapsedMsPtr);
+    GEPIT_EXPORT int32_t create_pipeline(LVErrorClusterPtr errorPtr, SessionHandle session, uint32_t nInputs, PipelineHandlePtr pipelinePtr);
+    GEPIT_EXPORT int32_t destroy_pipeline(LVErrorClusterPtr errorPtr, SessionHandle session, PipelineHandle pipeline);
+    GEPIT_EXPORT int32_t add_pipeline_stage(LVErrorClusterPtr errorPtr, SessionHandle session, PipelineHandle pipeline, LVPythonObjRef classInstance, LVStrHandle fnNameStrHandle, LVI32ArrayHandle inputSlotsHandle, int32_t outputSlot);
+    GEPIT_EXPORT int32_t run_pipeline(LVErrorClusterPtr errorPtr, SessionHandle session, PipelineHandle pipeline, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, uint32_t resultSlot, LVPythonObjRef *returnObjectPtr, LVDblArrayHandle *stageTimesHandlePtr);
+    GEPIT_EXPORT int32_t create_worker_pool(LVErrorClusterPtr errorPtr, SessionHandle session, int32_t nWorkers, LVStrHandle pythonExecutableStrHandle, WorkerPoolHandlePtr workerPoolPtr);
+    GEPIT_EXPORT int32_t destroy_worker_pool(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool);
+    GEPIT_EXPORT int32_t worker_pool_exec_string(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVStrHandle stringHandle);
+    GEPIT_EXPORT int32_t worker_pool_evaluate_string(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVStrHandle expressionHandle, LVPythonObjRef *returnObjectPtr);
+    GEPIT_EXPORT int32_t worker_pool_call_function(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVPythonObjRef classInstance, LVStrHandle fnNameStrHandle, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVPythonObjRef *returnObjectPtr);
+    GEPIT_EXPORT int32_t worker_pool_fetch(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVPythonObjRef object, LVPythonObjRef *returnObjectPtr);
+    GEPIT_EXPORT int32_t read_worker_pool_status(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, int32_t *aliveWorkersPtr, int32_t *restartsPtr, uint64_t *requestsPtr);
+    GEPIT_EXPORT int32_t create_mapped_array(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle pathStrHandle, LVStrHandle scopeNameStrHandle, LVNumericType type, LVI32ArrayHandle rowShapeHandle, uint64_t capacityRows, MappedArrayHandlePtr mappedArrayPtr);
+    GEPIT_EXPORT int32_t destroy_mapped_array(LVErrorClusterPtr errorPtr, SessionHandle session, MappedArrayHandle mappedArray);
+    GEPIT_EXPORT int32_t write_mapped_array_rows(LVErrorClusterPtr errorPtr, SessionHandle session, MappedArrayHandle mappedArray, LVNumericType type, LVVoid_t arrayHandle, uint64_t *rowsPtr);
+    GEPIT_EXPORT int32_t read_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle, LVArgumentTypeInfoHandle typesInfoHandle, LVArgumentClusterPtr valuesPtr, LVDblArrayHandle *scalarsHandlePtr, LVBooleanArrayHandle *foundHandlePtr);
+    GEPIT_EXPORT int32_t write_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle, LVArgumentTypeInfoHandle typesInfoHandle, LVArgumentClusterPtr valuesPtr, LVDblArrayHandle scalarsHandle);
+    GEPIT_EXPORT int32_t watch_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle);
+    GEPIT_EXPORT int32_t unwatch_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle);
+    GEPIT_EXPORT int32_t set_watch_user_event(LVErrorClusterPtr errorPtr, SessionHandle session, LVUserEventRef *eventRefPtr);
+    GEPIT_EXPORT int32_t read_watch_change_count(LVErrorClusterPtr errorPtr, SessionHandle session, uint64_t *changeCountPtr);
+    GEPIT_EXPORT int32_t read_changed_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle, LVArgumentTypeInfoHandle typesInfoHandle, LVArgumentClusterPtr valuesPtr, LVDblArrayHandle *scalarsHandlePtr, LVBooleanArrayHandle *changedHandlePtr);
     GEPIT_EXPORT int32_t scope_as_str(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandlePtr handle);
+    GEPIT_EXPORT int32_t scope_summary(LVErrorClusterPtr errorPtr, SessionHandle session, int32_t maxLength, LVStrHandlePtr handle);
+    GEPIT_EXPORT int32_t scope_keys(LVErrorClusterPtr errorPtr, SessionHandle session, int64_t *cursorPtr, int32_t maxKeys, LVStrHandlePtr keysStrHandlePtr, LVBoolean *donePtr);
+    GEPIT_EXPORT int32_t cast_py_object_to_array(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, LVNumericType type, uint8_t ndims, LVVoid_t *arrayHandlePtr);
+    GEPIT_EXPORT int32_t cast_py_object_to_array_region(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, LVNumericType type, uint8_t ndims, LVArrayRegionPtr regionPtr, LVVoid_t arrayHandle);
+    GEPIT_EXPORT int32_t iterator_next_into_array(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef iterator, LVNumericType type, uint8_t ndims, LVBoolean prefetch, LVVoid_t *arrayHandlePtr, LVBoolean *exhaustedPtr);
     GEPIT_EXPORT int32_t cast_py_object_to_string(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, LVStrHandlePtr strHandlePtr);
     GEPIT_EXPORT int32_t py_object_print_to_str(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, LVStrHandlePtr strHandlePtr);
+    GEPIT_EXPORT int32_t py_object_print_to_str_bounded(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, int32_t maxLength, int32_t maxItems, LVStrHandlePtr strHandlePtr);
+    GEPIT_EXPORT int32_t configure_buffer_pool(LVErrorClusterPtr errorPtr, SessionHandle session, uint32_t maxBuffers, uint64_t maxBytes);
+    GEPIT_EXPORT int32_t read_buffer_pool_stats(LVErrorClusterPtr errorPtr, SessionHandle session, LVBufferPoolStatsPtr statsPtr);
+    GEPIT_EXPORT int32_t read_aligned_marshalling_stats(LVErrorClusterPtr errorPtr, SessionHandle session, LVAlignedMarshallingStatsPtr statsPtr);
+    GEPIT_EXPORT int32_t read_python_error(LVErrorClusterPtr errorPtr, SessionHandle session, LVBoolean *availablePtr, LVStrHandlePtr typeStrHandlePtr, LVStrHandlePtr messageStrHandlePtr, LVStrHandlePtr tracebackStrHandlePtr, LVPythonObjRef *exceptionObjectPtr);
+    GEPIT_EXPORT int32_t clear_python_error(LVErrorClusterPtr errorPtr, SessionHandle session);
+    GEPIT_EXPORT int32_t start_profiling(LVErrorClusterPtr errorPtr, SessionHandle session, int32_t intervalUs);
+    GEPIT_EXPORT int32_t stop_profiling(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandlePtr collapsedStacksStrHandlePtr);
+    GEPIT_EXPORT int32_t start_event_loop(LVErrorClusterPtr errorPtr, SessionHandle session);
+    GEPIT_EXPORT int32_t stop_event_loop(LVErrorClusterPtr errorPtr, SessionHandle session);
+    GEPIT_EXPORT int32_t schedule_coroutine(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef classInstance, LVStrHandle fnName, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVPythonObjRef *futurePtr);
+    GEPIT_EXPORT int32_t wait_future(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef future, int32_t timeoutMs, LVBoolean *donePtr, LVPythonObjRef *resultPtr);
+    GEPIT_EXPORT int32_t cancel_future(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef future, LVBoolean *cancelledPtr);
 }
 
 // utility functions
-MgErr writePythonExceptionErr(LVErrorClusterPtr, std::string, std::string);
-MgErr writeInvalidPythonObjectRefErr(LVErrorClusterPtr errorPtr, std::string functionName);
-MgErr writeStdExceptionErr(LVErrorClusterPtr, std::string, std::string);
-MgErr writeInvalidSessionHandleErr(LVErrorClusterPtr, std::string);
-MgErr writeUnkownErr(LVErrorClusterPtr, std::string);
\ No newline at end of file
+MgErr writePythonExceptionErr(LVErrorClusterPtr, Session *, const char *, pybind11::error_already_set const &);
+MgErr writeInvalidPythonObjectRefErr(LVErrorClusterPtr errorPtr, const char *functionName);
+MgErr writeStdExceptionErr(LVErrorClusterPtr, const char *, const char *);
+MgErr writeInvalidSessionHandleErr(LVErrorClusterPtr, const char *);
+MgErr writeInvalidCallSiteHandleErr(LVErrorClusterPtr, const char *);
+MgErr writeInvalidPipelineHandleErr(LVErrorClusterPtr, const char *);
+MgErr writeInvalidMappedArrayHandleErr(LVErrorClusterPtr, const char *);
+MgErr writeInvalidWorkerPoolHandleErr(LVErrorClusterPtr, const char *);
+MgErr writeUnkownErr(LVErrorClusterPtr, const char *);
+MgErr writeInterpreterConfigIgnoredWarn(LVErrorClusterPtr, const char *);
+
+// python str with a single shared (interned) instance per value
+pybind11::str internedStr(std::string_view s);
+
+// view of the characters in a LVStrHandle
+std::string_view lvStrHandleToStringView(LVStrHandle handle);
+
+// copy a LVStrHandle to a Python str (without an intermediate std::string)
+pybind11::str lvStrHandleToPyStr(LVStrHandle handle);
+
+// write doubles to a (resized) 1D LabVIEW DBL array
+MgErr writeDoublesToDblArrayHandlePtr(LVDblArrayHandle *handlePtr, std::span<const double> values);
+MgErr writeBooleansToBooleanArrayHandlePtr(LVBooleanArrayHandle *handlePtr, std::span<const LVBoolean> values);
+
+// copy a LabVIEW string array to a vector of std::strings
+std::vector<std::string> lvStrArrayHandleToStdStrings(LVStrArrayHandle handle);
\ No newline at end of file
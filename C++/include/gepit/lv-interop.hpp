@@ -4,8 +4,10 @@
 // with NI provided libraries at compile time
 
 #pragma once
+#include <cstring>
 #include <numeric>
 #include <string>
+#include <string_view>
 #include <type_traits> // used to define function types
 
 #define WIN32_LEAN_AND_MEAN
@@ -13,14 +15,24 @@
 #include <windows.h>
 
 // LV NumericArrayResize Type Codes
+#define LV_I8_TYPECODE 1
+#define LV_I16_TYPECODE 2
+#define LV_I32_TYPECODE 3
+#define LV_I64_TYPECODE 4
 #define LV_U8_TYPECODE 5
+#define LV_U16_TYPECODE 6
 #define LV_U32_TYPECODE 7
 #define LV_U64_TYPECODE 8
 #define LV_FLOAT_TYPECODE 9
 #define LV_DOUBLE_TYPECODE 10
+#define LV_EXT_TYPECODE 11
 
 typedef int32_t MgErr;
 
+// LabVIEW memory manager error returned when a string or array would not fit its int32 length fields
+#define LV_MFULL_ERR 2
+typedef uint32_t LVUserEventRef;
+
 // define types with byte-packing specified
 // cmake sizeof void used to determine bitness
 #ifdef _32_BIT_ENV_
@@ -40,6 +52,7 @@ typedef struct {
 } LVStr, *LVStrPtr, **LVStrHandle, ***LVStrHandlePtr;
     
 // LabVIEW Array Template
+// each dimension is limited to 2^31-1 elements, the total size is not (multi-GiB arrays are fine in 64-bit LabVIEW)
 template <unsigned ndims, typename datatype>
 struct LVArray_t
 {
@@ -49,11 +62,10 @@ struct LVArray_t
     datatype* data(size_t byteOffset=0)
         {
     #ifndef _32_BIT_ENV_
-            if (sizeof(datatype) < 8)
-            {
-                return reinterpret_cast<datatype*>(buffer + byteOffset);
-            }
-            return reinterpret_cast<datatype*>(buffer + 4 + byteOffset); // 8-byte aligned data
+            // 64-bit LabVIEW aligns the elements to their own alignment (at most 8), padding after the dims if needed
+            constexpr size_t alignment = alignof(datatype) < 8 ? alignof(datatype) : 8;
+            constexpr size_t padding = (alignment - (ndims * sizeof(int32_t)) % alignment) % alignment;
+            return reinterpret_cast<datatype*>(buffer + padding + byteOffset);
     #else
             datatype* p = reinterpret_cast<datatype*>(buffer + byteOffset);
             return p;
@@ -75,17 +87,17 @@ typedef struct{
 
 
 // setup to import some functions exported from LabVIEW.exe / RTE at runtime
+// the functions are looked up on first use, which is safe from any number of threads
 MgErr LVNumericArrayResize(int32_t typeCode, int32_t numDims, void* handle, size_t size);
-// define the numericArrayResize function pointer type
-using numericArrayResizePtr = std::add_pointer<MgErr(int32_t, int32_t, void *handle, size_t size)>::type;
-// create a static variable to store the pointer
-static numericArrayResizePtr numericArrayResizeImp = nullptr;
 
-// write a std::string to a LabVIEW String-Handle Pointer
-MgErr writeStringToStringHandlePtr(LVStrHandlePtr,std::string);
+// fire a LabVIEW user event, data must match the event's data type
+MgErr LVPostUserEvent(LVUserEventRef ref, void *data);
+
+// write a string to a LabVIEW String-Handle Pointer
+MgErr writeStringToStringHandlePtr(LVStrHandlePtr, std::string_view);
 
 // write to an LabVIEW Error
-MgErr writeErrorToErrorClusterPtr(LVErrorClusterPtr, int, std::string, std::string);
+MgErr writeErrorToErrorClusterPtr(LVErrorClusterPtr, int32_t, std::string_view, std::string_view);
 
 // copy a LVStrHandle to a std::string
 std::string lvStrHandleToStdString(LVStrHandle handle);
\ No newline at end of file
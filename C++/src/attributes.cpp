@@ -0,0 +1,208 @@
+#include <cmath>
+#include <limits>
+
+#include "attributes.hpp"
+#include "call-function.hpp"
+#include "lv-array.hpp"
+#include "waveform.hpp"
+
+std::vector<pybind11::str> internAttributeNames(Session *session, LVStrArrayHandle namesHandle)
+{
+    size_t count = namesHandle && (*namesHandle) ? (*namesHandle)->dims[0] : 0;
+    std::vector<pybind11::str> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        names.push_back(session->internName(lvStrHandleToStringView((*namesHandle)->data()[i])));
+    }
+    return names;
+}
+
+std::span<const LVTypeInfo> attributeTypes(LVArgumentTypeInfoHandle typesInfoHandle, size_t count)
+{
+    size_t ntypes = typesInfoHandle && (*typesInfoHandle) ? (*typesInfoHandle)->dims[0] : 0;
+    if (ntypes != count)
+    {
+        throw std::invalid_argument("The number of attribute types (" + std::to_string(ntypes) + ") does not match the number of names (" + std::to_string(count) + ").");
+    }
+    return count ? std::span<const LVTypeInfo>((*typesInfoHandle)->data(), count) : std::span<const LVTypeInfo>();
+}
+
+static void writePyStrToStringHandlePtr(pybind11::handle value, LVStrHandlePtr strHandlePtr)
+{
+    // use the UTF-8 cached on str objects rather than building a std::string
+    pybind11::object text = PyUnicode_Check(value.ptr()) ? pybind11::reinterpret_borrow<pybind11::object>(value) : pybind11::str(value);
+    Py_ssize_t length;
+    const char *utf8 = PyUnicode_AsUTF8AndSize(text.ptr(), &length);
+    if (!utf8)
+    {
+        throw pybind11::error_already_set();
+    }
+    MgErr err = writeStringToStringHandlePtr(strHandlePtr, std::string_view(utf8, length));
+    if (err != 0)
+    {
+        throw std::runtime_error("LabVIEW could not resize the string (error " + std::to_string(err) + ").");
+    }
+}
+
+void readAttributeValues(Session *session, std::span<const pybind11::str> names, std::span<const LVTypeInfo> types,
+                         LVArgumentClusterPtr valuesPtr, std::vector<double> &scalars, std::vector<LVBoolean> &found,
+                         const std::vector<LVBoolean> *selected)
+{
+    scalars.assign(names.size(), std::numeric_limits<double>::quiet_NaN());
+    found.assign(names.size(), LVBooleanFalse);
+
+    size_t slot = 0;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        // values always go back to LabVIEW as plain arrays, argument modes only matter for writes
+        const LVTypeInfo typeInfo{lvBaseType(types[i].type), types[i].ndims};
+        bool usesSlot = typeInfo.type != LVNumericType::DBL_SCALAR;
+
+        if (selected && !(*selected)[i])
+        {
+            slot += usesSlot;
+            continue;
+        }
+
+        PyObject *value = PyDict_GetItemWithError(session->scope.ptr(), names[i].ptr());
+        if (!value)
+        {
+            if (PyErr_Occurred())
+            {
+                throw pybind11::error_already_set();
+            }
+            slot += usesSlot;
+            continue;
+        }
+        found[i] = LVBooleanTrue;
+
+        switch (typeInfo.type)
+        {
+        case LVNumericType::DBL_SCALAR:
+            scalars[i] = PyFloat_AsDouble(value);
+            if (scalars[i] == -1.0 && PyErr_Occurred())
+            {
+                throw pybind11::error_already_set();
+            }
+            break;
+        case LVNumericType::STRING:
+            writePyStrToStringHandlePtr(value, reinterpret_cast<LVStrHandlePtr>(&valuesPtr[slot]));
+            break;
+        case LVNumericType::PYOBJ:
+            valuesPtr[slot] = session->keepObject(pybind11::reinterpret_borrow<pybind11::object>(value));
+            break;
+        default:
+            writeArrayToLVArrayHandlePtr(value, typeInfo, &valuesPtr[slot]);
+            break;
+        }
+        slot += usesSlot;
+    }
+}
+
+int32_t read_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle, LVArgumentTypeInfoHandle typesInfoHandle, LVArgumentClusterPtr valuesPtr, LVDblArrayHandle *scalarsHandlePtr, LVBooleanArrayHandle *foundHandlePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto names = internAttributeNames(session, namesHandle);
+        auto types = attributeTypes(typesInfoHandle, names.size());
+
+        std::vector<double> scalars;
+        std::vector<LVBoolean> found;
+        readAttributeValues(session, names, types, valuesPtr, scalars, found);
+
+        MgErr err = writeDoublesToDblArrayHandlePtr(scalarsHandlePtr, scalars);
+        if (err == 0)
+        {
+            err = writeBooleansToBooleanArrayHandlePtr(foundHandlePtr, found);
+        }
+        if (err != 0)
+        {
+            throw std::runtime_error("LabVIEW could not resize the output arrays (error " + std::to_string(err) + ").");
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t write_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle, LVArgumentTypeInfoHandle typesInfoHandle, LVArgumentClusterPtr valuesPtr, LVDblArrayHandle scalarsHandle)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto names = internAttributeNames(session, namesHandle);
+        auto types = attributeTypes(typesInfoHandle, names.size());
+        size_t nscalars = scalarsHandle && (*scalarsHandle) ? (*scalarsHandle)->dims[0] : 0;
+
+        size_t slot = 0;
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            const LVTypeInfo &typeInfo = types[i];
+            pybind11::object value;
+            switch (lvBaseType(typeInfo.type))
+            {
+            case LVNumericType::DBL_SCALAR:
+                if (i >= nscalars)
+                {
+                    throw std::out_of_range("No scalar value was supplied for attribute " + std::to_string(i) + ".");
+                }
+                value = pybind11::float_((*scalarsHandle)->data()[i]);
+                break;
+            case LVNumericType::STRING:
+            {
+                auto text = lvStrHandleToStringView(reinterpret_cast<LVStrHandle>(valuesPtr[slot++]));
+                value = pybind11::str(text.data(), text.size());
+                break;
+            }
+            case LVNumericType::PYOBJ:
+                value = convertHandleToPythonObject(session, valuesPtr[slot++], typeInfo);
+                break;
+            case LVNumericType::DBL_WAVEFORM:
+            case LVNumericType::DBL_WAVEFORM_ARRAY:
+                value = copyWaveforms(convertHandleToPythonObject(session, valuesPtr[slot++], typeInfo));
+                break;
+            default:
+                // the LabVIEW array only lives for the duration of the call, so store a numpy copy whatever the mode
+                value = convertHandleToPythonObject(session, valuesPtr[slot++], {lvBaseType(typeInfo.type), typeInfo.ndims}).attr("copy")();
+                break;
+            }
+            if (PyDict_SetItem(session->scope.ptr(), names[i].ptr(), value.ptr()) != 0)
+            {
+                throw pybind11::error_already_set();
+            }
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <gepit/gepit.hpp>
+
+// interned names for the entries of a LabVIEW string array (GIL held)
+std::vector<pybind11::str> internAttributeNames(Session *session, LVStrArrayHandle namesHandle);
+
+// the type info of count attributes, throws if the LabVIEW arrays don't line up
+std::span<const LVTypeInfo> attributeTypes(LVArgumentTypeInfoHandle typesInfoHandle, size_t count);
+
+// read the scope variables names[i] into LabVIEW values described by types[i] (GIL held)
+// DBL_SCALAR values go to scalars[i], every other type uses the next handle slot of valuesPtr
+// variables that are not in the scope (or not selected) are flagged in found and their outputs are left alone
+void readAttributeValues(Session *session, std::span<const pybind11::str> names, std::span<const LVTypeInfo> types,
+                         LVArgumentClusterPtr valuesPtr, std::vector<double> &scalars, std::vector<LVBoolean> &found,
+                         const std::vector<LVBoolean> *selected = nullptr);
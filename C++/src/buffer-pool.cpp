@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <numeric>
+
+#include "buffer-pool.hpp"
+
+// owner of a pooled buffer, lives in the capsule used as the numpy base object
+struct PooledBuffer
+{
+    std::shared_ptr<BufferPool> pool;
+    void *data;
+    size_t bytes;
+};
+
+static void *allocate_aligned(size_t bytes)
+{
+    return ::operator new(bytes, std::align_val_t(BufferPool::alignment));
+}
+
+static void free_aligned(void *buffer)
+{
+    ::operator delete(buffer, std::align_val_t(BufferPool::alignment));
+}
+
+BufferPool::BufferPool(size_t maxBuffers, size_t maxBytes) : maxBuffers(maxBuffers), maxBytes(maxBytes), idleBytes(0), stats{},
+                                                             alignedArgs(0), copiedArgs(0), copiedArgBytes(0)
+{
+    // nothing else to construct
+}
+
+BufferPool::~BufferPool()
+{
+    for (auto &[bytes, buffer] : idleBuffers)
+    {
+        free_aligned(buffer);
+    }
+}
+
+void BufferPool::configure(size_t maxBuffers, size_t maxBytes)
+{
+    const std::lock_guard lock(mutex);
+    this->maxBuffers = maxBuffers;
+    this->maxBytes = maxBytes;
+    trim();
+}
+
+LVBufferPoolStats BufferPool::getStats()
+{
+    const std::lock_guard lock(mutex);
+    LVBufferPoolStats current = stats;
+    current.idleBuffers = idleBuffers.size();
+    current.idleBytes = idleBytes;
+    return current;
+}
+
+// free the largest idle buffers until the pool is within its limits (caller holds the mutex)
+void BufferPool::trim()
+{
+    while (!idleBuffers.empty() && (idleBuffers.size() > maxBuffers || idleBytes > maxBytes))
+    {
+        auto largest = std::prev(idleBuffers.end());
+        idleBytes -= largest->first;
+        free_aligned(largest->second);
+        idleBuffers.erase(largest);
+        stats.evicted++;
+    }
+}
+
+void *BufferPool::acquire(size_t bytes)
+{
+    bytes = std::max(bytes, alignment);
+    {
+        const std::lock_guard lock(mutex);
+        auto match = idleBuffers.find(bytes);
+        if (match != idleBuffers.end())
+        {
+            void *buffer = match->second;
+            idleBytes -= bytes;
+            idleBuffers.erase(match);
+            stats.hits++;
+            return buffer;
+        }
+        stats.misses++;
+    }
+    return allocate_aligned(bytes);
+}
+
+void BufferPool::release(void *buffer, size_t bytes)
+{
+    bytes = std::max(bytes, alignment);
+    const std::lock_guard lock(mutex);
+    if (bytes > maxBytes || maxBuffers == 0)
+    {
+        free_aligned(buffer);
+        stats.evicted++;
+        return;
+    }
+    idleBuffers.emplace(bytes, buffer);
+    idleBytes += bytes;
+    stats.returned++;
+    trim();
+}
+
+pybind11::array BufferPool::array(pybind11::dtype dtype, std::vector<pybind11::ssize_t> shape)
+{
+    size_t bytes = std::accumulate(shape.begin(), shape.end(), static_cast<size_t>(dtype.itemsize()), std::multiplies<size_t>());
+
+    auto owner = std::make_unique<PooledBuffer>(PooledBuffer{shared_from_this(), acquire(bytes), bytes});
+    void *data = owner->data;
+
+    // the capsule becomes the array's base object, hand the buffer back when numpy drops it
+    pybind11::capsule base(owner.get(), [](void *ptr)
+    {
+        auto owner = static_cast<PooledBuffer *>(ptr);
+        owner->pool->release(owner->data, owner->bytes);
+        delete owner;
+    });
+    owner.release();
+
+    return pybind11::array(dtype, shape, data, base);
+}
+
+void copyArrayData(pybind11::array destination, pybind11::array source)
+{
+    bool contiguous = (destination.flags() & source.flags() & pybind11::array::c_style) != 0;
+    if (contiguous)
+    {
+        std::memcpy(const_cast<void *>(destination.data()), source.data(), source.nbytes());
+        return;
+    }
+    // strided regions
+    pybind11::module_::import("numpy").attr("copyto")(destination, source);
+}
+
+pybind11::array BufferPool::alignedCopy(pybind11::array view)
+{
+    if (reinterpret_cast<uintptr_t>(view.data()) % alignment == 0)
+    {
+        alignedArgs++;
+        return view;
+    }
+    std::vector<pybind11::ssize_t> shape(view.shape(), view.shape() + view.ndim());
+    auto scratch = array(view.dtype(), shape);
+    copyArrayData(scratch, view);
+    copiedArgs++;
+    copiedArgBytes += view.nbytes();
+    return scratch;
+}
+
+LVAlignedMarshallingStats BufferPool::getAlignmentStats()
+{
+    return {alignedArgs.load(), copiedArgs.load(), copiedArgBytes.load()};
+}
+
+static Session *active_session_for_pool()
+{
+    Session *session = Session::active();
+    if (!session)
+    {
+        throw std::runtime_error("gepit.pool can only be used from code called through a gepit session");
+    }
+    return session;
+}
+
+static pybind11::array pool_get(pybind11::object shapeObj, pybind11::object dtypeObj)
+{
+    Session *session = active_session_for_pool();
+
+    std::vector<pybind11::ssize_t> shape;
+    if (pybind11::isinstance<pybind11::int_>(shapeObj))
+    {
+        shape.push_back(shapeObj.cast<pybind11::ssize_t>());
+    }
+    else
+    {
+        for (auto d : shapeObj)
+        {
+            shape.push_back(d.cast<pybind11::ssize_t>());
+        }
+    }
+    if (std::any_of(shape.begin(), shape.end(), [](pybind11::ssize_t d) { return d < 0; }))
+    {
+        throw std::invalid_argument("gepit.pool.get() shape dimensions must not be negative");
+    }
+
+    // numpy.dtype(None) is float64, matching numpy.empty
+    return session->pool->array(pybind11::dtype::from_args(dtypeObj), shape);
+}
+
+static pybind11::dict pool_stats()
+{
+    auto stats = active_session_for_pool()->pool->getStats();
+    pybind11::dict d;
+    d["hits"] = stats.hits;
+    d["misses"] = stats.misses;
+    d["returned"] = stats.returned;
+    d["evicted"] = stats.evicted;
+    d["idle_buffers"] = stats.idleBuffers;
+    d["idle_bytes"] = stats.idleBytes;
+    auto alignment = active_session_for_pool()->pool->getAlignmentStats();
+    d["aligned_args"] = alignment.aligned;
+    d["copied_args"] = alignment.copied;
+    d["copied_arg_bytes"] = alignment.copiedBytes;
+    return d;
+}
+
+// python side: gepit.pool.get(shape, dtype=None) and gepit.pool.stats()
+void bind_buffer_pool(pybind11::module_ &m)
+{
+    auto pool = m.def_submodule("pool", "Recycled output buffers for the calling gepit session");
+    pool.def("get", &pool_get, pybind11::arg("shape"), pybind11::arg("dtype") = pybind11::none(),
+             "Uninitialised ndarray backed by a recycled buffer (like numpy.empty)");
+    pool.def("stats", &pool_stats, "Hit/miss counters and idle buffer totals of the session pool");
+}
+
+int32_t configure_buffer_pool(LVErrorClusterPtr errorPtr, SessionHandle session, uint32_t maxBuffers, uint64_t maxBytes)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        session->pool->configure(maxBuffers, maxBytes);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t read_buffer_pool_stats(LVErrorClusterPtr errorPtr, SessionHandle session, LVBufferPoolStatsPtr statsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        *statsPtr = session->pool->getStats();
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t read_aligned_marshalling_stats(LVErrorClusterPtr errorPtr, SessionHandle session, LVAlignedMarshallingStatsPtr statsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    *statsPtr = session->pool->getAlignmentStats();
+    return 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <gepit/gepit.hpp>
+
+// pool limits used until configure_buffer_pool is called
+constexpr size_t defaultMaxPooledBuffers = 64;
+constexpr size_t defaultMaxPooledBytes = 256 * 1024 * 1024;
+
+// recycles the (64-byte aligned) memory behind numpy arrays handed out through gepit.pool
+// buffers are returned when the last reference to the array is dropped, e.g. by destroy_py_object
+class BufferPool : public std::enable_shared_from_this<BufferPool>
+{
+private:
+    std::mutex mutex;
+    // idle buffers keyed by their size in bytes
+    std::multimap<size_t, void *> idleBuffers;
+    size_t maxBuffers;
+    size_t maxBytes;
+    size_t idleBytes;
+    LVBufferPoolStats stats;
+    std::atomic<uint64_t> alignedArgs;
+    std::atomic<uint64_t> copiedArgs;
+    std::atomic<uint64_t> copiedArgBytes;
+
+    void trim();
+
+public:
+    static constexpr size_t alignment = 64;
+
+    BufferPool(size_t maxBuffers, size_t maxBytes);
+    ~BufferPool();
+    void configure(size_t maxBuffers, size_t maxBytes);
+    LVBufferPoolStats getStats();
+
+    // raw buffers: release must be passed the same size as acquire
+    void *acquire(size_t bytes);
+    void release(void *buffer, size_t bytes);
+
+    // uninitialised numpy array whose memory goes back to the pool on destruction
+    pybind11::array array(pybind11::dtype dtype, std::vector<pybind11::ssize_t> shape);
+
+    // view itself if its data is aligned, otherwise an aligned pooled copy of it (GIL held)
+    pybind11::array alignedCopy(pybind11::array view);
+    LVAlignedMarshallingStats getAlignmentStats();
+};
+
+// copy the elements of source into destination, which has the same shape and dtype (GIL held)
+void copyArrayData(pybind11::array destination, pybind11::array source);
+
+void bind_buffer_pool(pybind11::module_ &m);
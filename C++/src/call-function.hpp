@@ -1,5 +1,9 @@
+#pragma once
+
 #include <gepit/gepit.hpp>
 
+#include "lv-array.hpp"
+
 // create pybind11 format string
 template <typename T>
 std::string create_format_descriptor()
@@ -15,13 +19,14 @@ pybind11::dtype create_dtype()
 }
 
 // create pybind11 array
+// zero-copy view of a LabVIEW array handle, all sizes and strides are computed in 64 bits so multi-GiB arrays work
 template <typename T>
 pybind11::array cast_untyped_LVArrayHandle_to_numpy_array(LVVoid_t handle, size_t ndims)
 {
 
     int32_t* dimsPtr = *(reinterpret_cast<int32_t**>(handle));
-    // get buffer by offsetting dimsPtr by ndims
-    T *buffer = reinterpret_cast<T*>(dimsPtr + ndims);
+    // the elements start after the dims, aligned in 64-bit LabVIEW
+    T *buffer = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(dimsPtr) + lvArrayDataOffset<T>(ndims));
 
     // get dims as pybind11::ssize_t vector
     std::vector<pybind11::ssize_t> shape;
@@ -32,23 +37,13 @@ pybind11::array cast_untyped_LVArrayHandle_to_numpy_array(LVVoid_t handle, size_
         shape.push_back(pybind11::ssize_t_cast(d));
     }
 
-    // build strides pybind11::ssize_t vector
+    // C-order strides: the last dimension is contiguous, each earlier one spans all the later ones
     std::vector<pybind11::ssize_t> strides(ndims);
-
-    // reverse iterate over strides and shape
-    auto shapeIter = shape.rbegin();
-    for (auto it = strides.rbegin(); it != strides.rend(); it++)
+    pybind11::ssize_t stride = pybind11::ssize_t_cast(sizeof(T));
+    for (size_t i = ndims; i-- > 0;)
     {
-        if (it == strides.rbegin())
-        {
-            // last element
-            *it = pybind11::ssize_t_cast(sizeof(T));
-            continue;
-        }
-        // other values: take the previous value of strides
-        // and multiply by the current value in the shapeIter
-        *it = *shapeIter * (*(it - 1));
-        shapeIter++;
+        strides[i] = stride;
+        stride *= shape[i];
     }
     
     auto dtype = create_dtype<T>();
@@ -56,13 +51,37 @@ pybind11::array cast_untyped_LVArrayHandle_to_numpy_array(LVVoid_t handle, size_
     return pybind11::array(dtype, shape, strides, buffer, pybind11::array());
 }
 
-// templates to help with calling a handle's () operator with a std::vector of args
-template<std::size_t... S>
-pybind11::object function_call_with_args_vector(pybind11::handle &handle, const std::vector<pybind11::object>& args, std::index_sequence<S...>) {
-    return handle(args[S]...);
-}
+// vectorcall is only public API from Python 3.9
+#if PY_VERSION_HEX < 0x03090000
+#define PyObject_Vectorcall _PyObject_Vectorcall
+#endif
+
+// copies ALIGNED_MODE scratch arrays back into the LabVIEW arrays they stand in for once the call succeeded
+// exports create one around a call and finish() it inside their try, arguments converted without one aren't copied back
+class ArgumentCopyBack
+{
+private:
+    std::vector<std::pair<pybind11::array, pybind11::array>> copies;
+    ArgumentCopyBack *previous;
+
+public:
+    ArgumentCopyBack();
+    ~ArgumentCopyBack();
+    ArgumentCopyBack(const ArgumentCopyBack &) = delete;
+    // copy every scratch back, a failed call leaves the LabVIEW arrays as they were
+    void finish();
+    ArgumentCopyBack &operator=(const ArgumentCopyBack &) = delete;
+    // register scratch as the stand-in for target with the innermost ArgumentCopyBack on this thread
+    static void add(pybind11::array scratch, pybind11::array target);
+};
+
+pybind11::object convertHandleToPythonObject(SessionHandle session, LVVoid_t handle, LVTypeInfo typeInfo, const LVArrayRegion *region = nullptr);
+// argRegionsHandle is optional, its entries line up with the arguments (extra arguments use the whole array)
+void convertArgsToPythonObjects(SessionHandle session, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, std::vector<pybind11::object> &argObjects, LVArgumentRegionHandle argRegionsHandle = nullptr);
+
+// function in the session scope (null classInstance) or method of a stored object
+pybind11::object resolveCallable(SessionHandle session, LVPythonObjRef classInstance, pybind11::str fnName);
 
-template<std::size_t size>
-pybind11::object function_call_with_args_vector(pybind11::handle &handle, const std::vector<pybind11::object>& args) {
-    return function_call_with_args_vector(handle, args, std::make_index_sequence<size>());
-}
\ No newline at end of file
+// call fn with args, the last len(kwNames) of which are passed by keyword (kwNames may be a null handle)
+// argPointers is scratch space which callers can keep around to avoid reallocating it
+pybind11::object vectorcallWithArgs(pybind11::handle fn, const std::vector<pybind11::object> &args, pybind11::handle kwNames, std::vector<PyObject *> &argPointers);
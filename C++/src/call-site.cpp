@@ -0,0 +1,205 @@
+#include "call-site.hpp"
+
+CallSite::CallSite(pybind11::str fnName, pybind11::tuple kwNames) : fnName(fnName), kwNames(kwNames)
+{
+    busy.clear();
+}
+
+pybind11::object CallSite::call(SessionHandle session, LVPythonObjRef classInstance, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle)
+{
+    pybind11::object fn = resolveCallable(session, classInstance, fnName);
+    if (!memo.enabled())
+    {
+        return invoke(session, fn, argsPtr, argTypesInfoHandle, argRegionsHandle);
+    }
+
+    auto key = memo.key(session, fn, argsPtr, argTypesInfoHandle, argRegionsHandle);
+    if (auto cached = memo.find(key))
+    {
+        return *cached;
+    }
+    auto result = invoke(session, fn, argsPtr, argTypesInfoHandle, argRegionsHandle);
+    memo.insert(std::move(key), result);
+    return result;
+}
+
+pybind11::object CallSite::invoke(SessionHandle session, pybind11::handle fn, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle)
+{
+    if (busy.test_and_set())
+    {
+        // another thread is part way through a call on this call site
+        std::vector<pybind11::object> args;
+        std::vector<PyObject *> pointers;
+        convertArgsToPythonObjects(session, argsPtr, argTypesInfoHandle, args, argRegionsHandle);
+        return vectorcallWithArgs(fn, args, kwNames, pointers);
+    }
+
+    struct Release
+    {
+        CallSite *site;
+        ~Release()
+        {
+            site->argObjects.clear(); // keeps capacity
+            site->busy.clear();
+        }
+    } release{this};
+
+    convertArgsToPythonObjects(session, argsPtr, argTypesInfoHandle, argObjects, argRegionsHandle);
+    return vectorcallWithArgs(fn, argObjects, kwNames, argPointers);
+}
+
+int32_t create_call_site(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle fnNameStrHandle, LVStrArrayHandle kwNamesHandle, CallSiteHandlePtr callSitePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto names = lvStrArrayHandleToStdStrings(kwNamesHandle);
+        pybind11::tuple kwNames(names.size());
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            kwNames[i] = internedStr(names[i]);
+        }
+        *callSitePtr = new CallSite(internedStr(lvStrHandleToStdString(fnNameStrHandle)), kwNames);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t destroy_call_site(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!callSite)
+    {
+        return writeInvalidCallSiteHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        delete callSite;
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+static int32_t invokeCallSite(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVPythonObjRef classInstance, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle, LVPythonObjRef *returnObjectPtr, const char *exportName)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, exportName);
+    }
+    if (!callSite)
+    {
+        return writeInvalidCallSiteHandleErr(errorPtr, exportName);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        ScopedLatency timed(callSite->latency);
+        ActiveSessionGuard active(session);
+        ArgumentCopyBack copyBack;
+        auto result = callSite->call(session, classInstance, argsPtr, argTypesInfoHandle, argRegionsHandle);
+        copyBack.finish();
+        *returnObjectPtr = session->keepObject(std::move(result));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, exportName, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, exportName, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, exportName);
+    }
+    return 0;
+}
+
+int32_t invoke_call_site(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVPythonObjRef classInstance, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVPythonObjRef *returnObjectPtr)
+{
+    return invokeCallSite(errorPtr, session, callSite, classInstance, argsPtr, argTypesInfoHandle, nullptr, returnObjectPtr, __func__);
+}
+
+int32_t invoke_call_site_with_regions(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVPythonObjRef classInstance, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle, LVPythonObjRef *returnObjectPtr)
+{
+    return invokeCallSite(errorPtr, session, callSite, classInstance, argsPtr, argTypesInfoHandle, argRegionsHandle, returnObjectPtr, __func__);
+}
+
+int32_t configure_call_site_memo(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, uint64_t maxBytes)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!callSite)
+    {
+        return writeInvalidCallSiteHandleErr(errorPtr, __func__);
+    }
+    // evicted results are released here
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        callSite->memo.configure(static_cast<size_t>(maxBytes));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t read_call_site_memo_stats(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVBoolean reset, LVMemoStatsPtr statsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!callSite)
+    {
+        return writeInvalidCallSiteHandleErr(errorPtr, __func__);
+    }
+    *statsPtr = callSite->memo.getStats();
+    if (reset)
+    {
+        callSite->memo.resetStats();
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "call-function.hpp"
+#include "memo-cache.hpp"
+#include "realtime.hpp"
+
+// a prepared call_function: the function and keyword names are interned once when it is created
+// and the argument buffers are reused from call to call
+class CallSite
+{
+private:
+    // set while a call is using the argument buffers, a concurrent call falls back to its own
+    std::atomic_flag busy;
+    std::vector<pybind11::object> argObjects;
+    std::vector<PyObject *> argPointers;
+
+    pybind11::object invoke(SessionHandle session, pybind11::handle fn, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle);
+
+public:
+    const pybind11::str fnName;
+    // names of the trailing arguments, which are passed by keyword (empty for positional-only calls)
+    const pybind11::tuple kwNames;
+    // duration of every invoke_call_site
+    LatencyHistogram latency;
+    // results of earlier calls with the same arguments, off unless configure_call_site_memo is called
+    MemoCache memo;
+
+    CallSite(pybind11::str fnName, pybind11::tuple kwNames);
+    pybind11::object call(SessionHandle session, LVPythonObjRef classInstance, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle = nullptr);
+};
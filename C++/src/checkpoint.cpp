@@ -0,0 +1,314 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gepit/gepit.hpp>
+
+// checkpoint file: header, pickle stream (protocol 5), table of out-of-band buffers, then the buffers
+// every buffer starts on a 64-byte boundary, restored arrays are as aligned as pooled ones
+struct CheckpointHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t pickleOffset;
+    uint64_t pickleBytes;
+    uint64_t tableOffset;
+    uint64_t bufferCount;
+};
+
+struct CheckpointBuffer
+{
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+constexpr uint64_t checkpointAlignment = 64;
+// smaller buffers stay in the pickle stream rather than getting a 64-byte aligned slot of their own
+constexpr size_t checkpointInBandBytes = 64 * 1024;
+constexpr uint32_t checkpointHasObjects = 1;
+
+static uint64_t alignCheckpointOffset(uint64_t offset)
+{
+    return (offset + checkpointAlignment - 1) / checkpointAlignment * checkpointAlignment;
+}
+
+// code comes back by evaluating the session's scripts again, so it is never checkpointed
+static bool isCode(pybind11::handle value)
+{
+    return PyModule_Check(value.ptr()) || PyType_Check(value.ptr()) || PyFunction_Check(value.ptr()) || PyCFunction_Check(value.ptr());
+}
+
+static bool isDunder(std::string_view name)
+{
+    return name.size() > 4 && name.starts_with("__") && name.ends_with("__");
+}
+
+// returns the names (and object references) which could not be pickled, one per line
+static std::string checkpointSession(Session *session, pybind11::str path, bool includeObjects)
+{
+    auto dumps = pybind11::module_::import("pickle").attr("dumps");
+
+    // a dry run per value finds the ones that can't be pickled, out-of-band buffers aren't copied by it
+    auto outOfBand = pybind11::cpp_function([](pybind11::handle) { return false; });
+    auto picklable = [&](pybind11::handle value)
+    {
+        try
+        {
+            dumps(value, 5, pybind11::arg("buffer_callback") = outOfBand);
+            return true;
+        }
+        catch (pybind11::error_already_set const &)
+        {
+            return false;
+        }
+    };
+
+    std::string skipped;
+    pybind11::dict scope;
+    // pickling runs arbitrary __reduce__ methods, iterate over a copy in case one changes the scope
+    auto items = pybind11::reinterpret_steal<pybind11::dict>(PyDict_Copy(session->scope.ptr()));
+    if (!items)
+    {
+        throw pybind11::error_already_set();
+    }
+    for (auto item : items)
+    {
+        auto name = pybind11::str(item.first).cast<std::string>();
+        if (isDunder(name) || isCode(item.second))
+        {
+            continue;
+        }
+        if (!picklable(item.second))
+        {
+            skipped += name + "\n";
+            continue;
+        }
+        scope[item.first] = item.second;
+    }
+    pybind11::list objects;
+    if (includeObjects)
+    {
+        for (auto &[key, obj] : session->storedObjects())
+        {
+            if (!picklable(obj))
+            {
+                skipped += "object " + std::to_string(key) + "\n";
+                continue;
+            }
+            objects.append(pybind11::make_tuple(key, obj));
+        }
+    }
+
+    // one stream for everything, so objects referenced from several names are restored once
+    std::vector<pybind11::buffer_info> buffers;
+    auto collect = pybind11::cpp_function([&buffers](pybind11::object buffer)
+    {
+        auto info = pybind11::buffer(buffer.attr("raw")()).request();
+        if (static_cast<size_t>(info.size * info.itemsize) < checkpointInBandBytes)
+        {
+            return true;
+        }
+        buffers.push_back(std::move(info));
+        return false;
+    });
+    pybind11::dict root;
+    root["scope"] = scope;
+    root["objects"] = objects;
+    auto stream = dumps(root, 5, pybind11::arg("buffer_callback") = collect).cast<pybind11::bytes>();
+    auto streamView = std::string_view(stream);
+
+    CheckpointHeader header{};
+    std::memcpy(header.magic, "GEPITCKP", sizeof(header.magic));
+    header.version = 1;
+    header.flags = includeObjects ? checkpointHasObjects : 0;
+    header.pickleOffset = sizeof(CheckpointHeader);
+    header.pickleBytes = streamView.size();
+    header.tableOffset = alignCheckpointOffset(header.pickleOffset + header.pickleBytes);
+    header.bufferCount = buffers.size();
+    std::vector<CheckpointBuffer> table;
+    uint64_t offset = alignCheckpointOffset(header.tableOffset + buffers.size() * sizeof(CheckpointBuffer));
+    for (const auto &info : buffers)
+    {
+        auto bytes = static_cast<uint64_t>(info.size * info.itemsize);
+        table.push_back({offset, bytes});
+        offset = alignCheckpointOffset(offset + bytes);
+    }
+
+    // written next to the target and renamed over it at the end, an interrupted checkpoint leaves the previous one intact
+    auto os = pybind11::module_::import("os");
+    pybind11::str partialPath = path + pybind11::str(".partial");
+    auto file = pybind11::module_::import("io").attr("open")(partialPath, "wb");
+    try
+    {
+        uint64_t position = 0;
+        static const char padding[checkpointAlignment] = {};
+        auto write = [&](const void *data, size_t bytes)
+        {
+            // the file object releases the GIL while the data goes to disk
+            file.attr("write")(pybind11::memoryview::from_memory(data, pybind11::ssize_t_cast(bytes)));
+            position += bytes;
+        };
+        auto padTo = [&](uint64_t target)
+        {
+            write(padding, static_cast<size_t>(target - position));
+        };
+        write(&header, sizeof(header));
+        write(streamView.data(), streamView.size());
+        padTo(header.tableOffset);
+        write(table.data(), table.size() * sizeof(CheckpointBuffer));
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            padTo(table[i].offset);
+            write(buffers[i].ptr, static_cast<size_t>(table[i].bytes));
+        }
+        file.attr("close")();
+    }
+    catch (...)
+    {
+        file.attr("close")();
+        os.attr("remove")(partialPath);
+        throw;
+    }
+    os.attr("replace")(partialPath, path);
+    return skipped;
+}
+
+static void restoreSession(Session *session, pybind11::str path, bool restoreObjects)
+{
+    auto mmap = pybind11::module_::import("mmap");
+    pybind11::object mapped;
+    {
+        auto file = pybind11::module_::import("io").attr("open")(path, "rb");
+        try
+        {
+            // copy-on-write: restored arrays can be modified (filter state...) without changing the file
+            mapped = mmap.attr("mmap")(file.attr("fileno")(), 0, pybind11::arg("access") = mmap.attr("ACCESS_COPY"));
+        }
+        catch (...)
+        {
+            file.attr("close")();
+            throw;
+        }
+        // the mapping keeps its own handle to the file
+        file.attr("close")();
+    }
+    pybind11::memoryview view(mapped);
+    auto info = pybind11::buffer(view).request();
+    auto base = static_cast<const uint8_t *>(info.ptr);
+    auto size = static_cast<uint64_t>(info.size);
+
+    CheckpointHeader header;
+    if (size < sizeof(header))
+    {
+        throw std::invalid_argument("The file is too small to be a session checkpoint.");
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, "GEPITCKP", sizeof(header.magic)) != 0 || header.version != 1)
+    {
+        throw std::invalid_argument("The file is not a session checkpoint (or was written by a newer version).");
+    }
+    auto inFile = [size](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+    if (!inFile(header.pickleOffset, header.pickleBytes) || header.bufferCount > size / sizeof(CheckpointBuffer) ||
+        !inFile(header.tableOffset, header.bufferCount * sizeof(CheckpointBuffer)))
+    {
+        throw std::invalid_argument("The session checkpoint is truncated or damaged.");
+    }
+    if (restoreObjects && !(header.flags & checkpointHasObjects))
+    {
+        throw std::invalid_argument("The session checkpoint was written without the object store.");
+    }
+
+    auto slice = [&](uint64_t offset, uint64_t bytes)
+    {
+        return pybind11::object(view[pybind11::slice(pybind11::ssize_t_cast(offset), pybind11::ssize_t_cast(offset + bytes), 1)]);
+    };
+    // arrays are rebuilt on top of these slices of the mapping, their pages are read in as they are touched
+    pybind11::list buffers;
+    for (uint64_t i = 0; i < header.bufferCount; i++)
+    {
+        CheckpointBuffer entry;
+        std::memcpy(&entry, base + header.tableOffset + i * sizeof(CheckpointBuffer), sizeof(entry));
+        if (!inFile(entry.offset, entry.bytes))
+        {
+            throw std::invalid_argument("The session checkpoint is truncated or damaged.");
+        }
+        buffers.append(slice(entry.offset, entry.bytes));
+    }
+    auto loads = pybind11::module_::import("pickle").attr("loads");
+    pybind11::dict root = loads(slice(header.pickleOffset, header.pickleBytes), pybind11::arg("buffers") = buffers);
+
+    std::vector<std::pair<uint32_t, pybind11::object>> objects;
+    if (restoreObjects)
+    {
+        for (auto entry : root["objects"])
+        {
+            auto pair = entry.cast<pybind11::tuple>();
+            objects.emplace_back(pair[0].cast<uint32_t>(), pair[1]);
+        }
+        session->restoreObjects(std::move(objects));
+    }
+    if (PyDict_Update(session->scope.ptr(), root["scope"].ptr()) != 0)
+    {
+        throw pybind11::error_already_set();
+    }
+}
+
+int32_t checkpoint_session(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle pathStrHandle, LVBoolean includeObjects, LVStrHandlePtr skippedStrHandlePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        ActiveSessionGuard active(session);
+        auto skipped = checkpointSession(session, lvStrHandleToPyStr(pathStrHandle), includeObjects);
+        MgErr err = writeStringToStringHandlePtr(skippedStrHandlePtr, skipped);
+        if (err != 0)
+        {
+            throw std::runtime_error("LabVIEW could not resize the string (error " + std::to_string(err) + ").");
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t restore_session(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle pathStrHandle, LVBoolean restoreObjects)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        ActiveSessionGuard active(session);
+        restoreSession(session, lvStrHandleToPyStr(pathStrHandle), restoreObjects);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <gepit/gepit.hpp>
+
+int32_t read_python_error(LVErrorClusterPtr errorPtr, SessionHandle session, LVBoolean *availablePtr, LVStrHandlePtr typeStrHandlePtr, LVStrHandlePtr messageStrHandlePtr, LVStrHandlePtr tracebackStrHandlePtr, LVPythonObjRef *exceptionObjectPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto record = session->readLastError();
+        if (!record.value)
+        {
+            *availablePtr = LVBooleanFalse;
+            return 0;
+        }
+        *availablePtr = LVBooleanTrue;
+
+        // format the traceback the first time it is asked for
+        if (!record.formattedTraceback)
+        {
+            auto lines = pybind11::module_::import("traceback").attr("format_exception")(record.type, record.value, record.trace);
+            record.formattedTraceback = pybind11::str("").attr("join")(lines).cast<std::string>();
+            session->cacheFormattedTraceback(record.value, *record.formattedTraceback);
+        }
+
+        MgErr err = writeStringToStringHandlePtr(typeStrHandlePtr, record.type.attr("__name__").cast<std::string>());
+        if (err == 0)
+        {
+            err = writeStringToStringHandlePtr(messageStrHandlePtr, pybind11::str(record.value).cast<std::string>());
+        }
+        if (err == 0)
+        {
+            err = writeStringToStringHandlePtr(tracebackStrHandlePtr, *record.formattedTraceback);
+        }
+        if (err != 0)
+        {
+            return err;
+        }
+
+        // the exception instance (with __traceback__) can be inspected further from LabVIEW
+        // reading the same error again returns the same reference, so polling doesn't fill the object store
+        *exceptionObjectPtr = session->keepLastErrorValue(record.value);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        // don't let the failure to format replace the error being read
+        return writePythonExceptionErr(errorPtr, nullptr, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t clear_python_error(LVErrorClusterPtr errorPtr, SessionHandle session)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        // releases the traceback and with it any frames (and their locals) it keeps alive
+        session->writeLastError(PythonErrorRecord());
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, nullptr, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -6,13 +6,15 @@ int32_t evaluate_script(LVErrorClusterPtr errorPtr, SessionHandle session, LVStr
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
+        ActiveSessionGuard active(session);
         pybind11::eval_file(lvStrHandleToStdString(filePathStrHandle), session->scope);
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -31,14 +33,16 @@ int32_t evaluate_string(LVErrorClusterPtr errorPtr, SessionHandle session, LVStr
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
+        ActiveSessionGuard active(session);
         auto string = lvStrHandleToStdString(expressionHandle);
         *returnObjectPtr = session->keepObject(pybind11::eval(string, session->scope));
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
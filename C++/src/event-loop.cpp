@@ -0,0 +1,316 @@
+#include "call-function.hpp"
+#include "event-loop.hpp"
+#include "waveform.hpp"
+
+EventLoop::EventLoop() : ready(false)
+{
+    thread = std::thread(&EventLoop::run, this);
+    {
+        // the loop thread needs the GIL to create the loop
+        pybind11::gil_scoped_release release;
+        std::unique_lock lock(mutex);
+        started.wait(lock, [this]() { return ready; });
+    }
+    if (!startError.empty())
+    {
+        {
+            pybind11::gil_scoped_release release;
+            thread.join();
+        }
+        throw std::runtime_error("The event loop could not be started: " + startError);
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    // stop() has already joined the thread when the session or loop was shut down properly
+    if (thread.joinable())
+    {
+        pybind11::gil_scoped_release release;
+        stop();
+    }
+}
+
+void EventLoop::run()
+{
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto asyncio = pybind11::module_::import("asyncio");
+        pybind11::object created = asyncio.attr("new_event_loop")();
+        asyncio.attr("set_event_loop")(created);
+        {
+            const std::lock_guard lock(mutex);
+            loop = created;
+            ready = true;
+        }
+        started.notify_all();
+
+        // waits for I/O with the GIL released
+        created.attr("run_forever")();
+
+        // give the tasks still pending a chance to run their cleanup before the loop is closed
+        pybind11::tuple pending(asyncio.attr("all_tasks")(created));
+        for (auto task : pending)
+        {
+            task.attr("cancel")();
+        }
+        if (pending.size() > 0)
+        {
+            created.attr("run_until_complete")(asyncio.attr("gather")(*pending, pybind11::arg("return_exceptions") = true));
+        }
+        created.attr("run_until_complete")(created.attr("shutdown_asyncgens")());
+        created.attr("close")();
+    }
+    catch (std::exception const &e)
+    {
+        const std::lock_guard lock(mutex);
+        if (!ready)
+        {
+            startError = e.what();
+            ready = true;
+        }
+    }
+    started.notify_all();
+}
+
+pybind11::object EventLoop::schedule(pybind11::object coroutine)
+{
+    auto asyncio = pybind11::module_::import("asyncio");
+    if (!asyncio.attr("iscoroutine")(coroutine).cast<bool>())
+    {
+        throw pybind11::type_error("the function did not return a coroutine, only async def functions can be scheduled");
+    }
+    return asyncio.attr("run_coroutine_threadsafe")(coroutine, loop);
+}
+
+void EventLoop::stop()
+{
+    if (!thread.joinable())
+    {
+        return;
+    }
+    {
+        pybind11::gil_scoped_acquire gil;
+        if (!loop.attr("is_closed")().cast<bool>())
+        {
+            loop.attr("call_soon_threadsafe")(loop.attr("stop"));
+        }
+    }
+    thread.join();
+}
+
+int32_t start_event_loop(LVErrorClusterPtr errorPtr, SessionHandle session)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        {
+            const std::lock_guard lock(session->backgroundMutex);
+            if (session->eventLoop)
+            {
+                return 0;
+            }
+        }
+        // started outside the lock, it releases the GIL while the loop thread starts
+        auto eventLoop = std::make_shared<EventLoop>();
+        {
+            const std::lock_guard lock(session->backgroundMutex);
+            if (!session->eventLoop)
+            {
+                session->eventLoop = std::move(eventLoop);
+            }
+        }
+        // another thread started one first
+        if (eventLoop)
+        {
+            pybind11::gil_scoped_release release;
+            eventLoop->stop();
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t stop_event_loop(LVErrorClusterPtr errorPtr, SessionHandle session)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        std::shared_ptr<EventLoop> eventLoop;
+        {
+            const std::lock_guard lock(session->backgroundMutex);
+            eventLoop = std::move(session->eventLoop);
+        }
+        // no GIL here, the loop thread needs it to cancel and finish its tasks
+        if (eventLoop)
+        {
+            eventLoop->stop();
+            pybind11::gil_scoped_acquire gil;
+            eventLoop.reset();
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        pybind11::gil_scoped_acquire gil;
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t schedule_coroutine(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef classInstance, LVStrHandle fnNameStrHandle, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVPythonObjRef *futurePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        ActiveSessionGuard active(session);
+        std::shared_ptr<EventLoop> eventLoop;
+        {
+            const std::lock_guard lock(session->backgroundMutex);
+            eventLoop = session->eventLoop;
+        }
+        if (!eventLoop)
+        {
+            throw std::logic_error("The event loop of this session has not been started (start_event_loop).");
+        }
+        std::vector<pybind11::object> argObjects;
+        convertArgsToPythonObjects(session, argsPtr, argTypesInfoHandle, argObjects);
+        // the coroutine runs after this call returns, when the LabVIEW arrays may be gone, so it gets copies of them
+        size_t nargs = argObjects.size();
+        for (size_t i = 0; i < nargs; i++)
+        {
+            auto typeInfo = (*argTypesInfoHandle)->data()[i];
+            if (lvBaseType(typeInfo.type) == LVNumericType::PYOBJ)
+            {
+                continue;
+            }
+            if (lvArgumentMode(typeInfo.type) != NUMPY_MODE)
+            {
+                throw std::invalid_argument("Array arguments of scheduled coroutines are copied into numpy arrays, argument modes can't be used.");
+            }
+            argObjects[i] = lvIsWaveformType(lvBaseType(typeInfo.type)) ? copyWaveforms(argObjects[i]) : argObjects[i].attr("copy")();
+        }
+
+        pybind11::object fnHandle = resolveCallable(session, classInstance, lvStrHandleToPyStr(fnNameStrHandle));
+        std::vector<PyObject *> argPointers;
+        auto coroutine = vectorcallWithArgs(fnHandle, argObjects, pybind11::handle(), argPointers);
+        *futurePtr = session->keepObject(eventLoop->schedule(coroutine));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t wait_future(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef future, int32_t timeoutMs, LVBoolean *donePtr, LVPythonObjRef *resultPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        if (session->isNullObject(future))
+        {
+            return writeInvalidPythonObjectRefErr(errorPtr, __func__);
+        }
+        auto futureObj = session->getObject(future);
+        // 0 only polls, a negative timeout waits for as long as it takes
+        if (!futureObj.attr("done")().cast<bool>() && timeoutMs != 0)
+        {
+            // concurrent.futures.wait releases the GIL while it blocks
+            auto timeout = timeoutMs < 0 ? pybind11::object(pybind11::none()) : pybind11::object(pybind11::float_(timeoutMs / 1000.0));
+            pybind11::module_::import("concurrent.futures").attr("wait")(pybind11::make_tuple(futureObj), timeout);
+        }
+        *donePtr = futureObj.attr("done")().cast<bool>() ? LVBooleanTrue : LVBooleanFalse;
+        if (*donePtr)
+        {
+            // raises the coroutine's exception (or CancelledError) as the error of this call
+            *resultPtr = session->keepObject(futureObj.attr("result")());
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t cancel_future(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef future, LVBoolean *cancelledPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        if (session->isNullObject(future))
+        {
+            return writeInvalidPythonObjectRefErr(errorPtr, __func__);
+        }
+        // cancelling the concurrent future cancels the task on the loop
+        *cancelledPtr = session->getObject(future).attr("cancel")().cast<bool>() ? LVBooleanTrue : LVBooleanFalse;
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <gepit/gepit.hpp>
+
+// an asyncio event loop running forever on its own thread, so coroutines scheduled from LabVIEW
+// overlap their waits without a new loop (asyncio.run) per call
+class EventLoop
+{
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable started;
+    bool ready;
+    std::string startError;
+    // the loop object, set by the loop thread and only touched with the GIL held
+    pybind11::object loop;
+
+    void run();
+
+public:
+    // starts the thread and waits until the loop is running (GIL held, it is released while waiting)
+    EventLoop();
+    ~EventLoop();
+    // schedule a coroutine on the loop, returns the concurrent.futures.Future of its result (GIL held)
+    pybind11::object schedule(pybind11::object coroutine);
+    // stop the loop, cancel the tasks still pending and join the thread, it must not be called while holding the GIL
+    void stop();
+};
@@ -7,13 +7,15 @@ int32_t exec_string(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHand
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
+        ActiveSessionGuard active(session);
         pybind11::exec(lvStrHandleToStdString(stringHandle), session->scope);
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -0,0 +1,24 @@
+#include <gepit/gepit.hpp>
+
+#include "buffer-pool.hpp"
+#include "kernels.hpp"
+#include "mapped-array.hpp"
+#include "tensor-exchange.hpp"
+#include "watch.hpp"
+#include "waveform.hpp"
+
+// the "gepit" module is built into the DLL and can be imported by session code
+PYBIND11_EMBEDDED_MODULE(gepit, m)
+{
+    m.doc() = "Helpers for Python code running inside the G Embedded Python Interpreter Toolkit";
+#ifdef Py_GIL_DISABLED
+    // importing a module that doesn't declare this re-enables the GIL in free-threaded builds
+    PyUnstable_Module_SetGIL(m.ptr(), Py_MOD_GIL_NOT_USED);
+#endif
+    bind_buffer_pool(m);
+    bind_kernels(m);
+    bind_mapped_array(m);
+    bind_tensor_exchange(m);
+    bind_watch(m);
+    bind_waveform(m);
+}
@@ -1,11 +1,95 @@
+#include <chrono>
+#include <condition_variable>
+#include <sstream>
+#include <thread>
+
 #include <gepit/gepit.hpp>
 
+#include "parallel-map.hpp"
+#include "watch.hpp"
+
+// thread state of the thread that started the interpreter
+// the GIL is released between DLL calls so that other threads (e.g. warmup) can run Python code
+static PyThreadState *mainThreadState = nullptr;
+static std::thread::id mainThreadId;
+
+// background imports requested by initialize_interpreter_with_config
+static struct
+{
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable done;
+    bool ready = true;
+    std::string report;
+} warmup;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void release_main_thread()
+{
+    mainThreadState = PyEval_SaveThread();
+    mainThreadId = std::this_thread::get_id();
+}
+
+static void start_warmup(std::vector<std::string> modules, std::string report)
+{
+    {
+        const std::lock_guard lock(warmup.mutex);
+        warmup.ready = modules.empty();
+        warmup.report = report;
+    }
+    if (modules.empty())
+    {
+        return;
+    }
+
+    warmup.thread = std::thread([modules = std::move(modules)]()
+    {
+        auto warmupStart = std::chrono::steady_clock::now();
+        std::ostringstream report;
+        {
+            pybind11::gil_scoped_acquire gil;
+            for (const auto &name : modules)
+            {
+                auto start = std::chrono::steady_clock::now();
+                try
+                {
+                    pybind11::module_::import(name.c_str());
+                    report << "import " << name << ": " << elapsed_ms(start) << " ms\n";
+                }
+                catch (pybind11::error_already_set const &e)
+                {
+                    report << "import " << name << ": FAILED " << e.what() << "\n";
+                }
+            }
+        }
+        report << "warmup total: " << elapsed_ms(warmupStart) << " ms\n";
+
+        const std::lock_guard lock(warmup.mutex);
+        warmup.report += report.str();
+        warmup.ready = true;
+        warmup.done.notify_all();
+    });
+}
+
+static void join_warmup()
+{
+    if (warmup.thread.joinable())
+    {
+        warmup.thread.join();
+    }
+}
+
 int32_t initialize_interpreter(LVErrorClusterPtr errorPtr, LVBoolean *alreadyRunningPtr)
 {
     try
     {
         // try starting the interpreter (it might already be running)
         pybind11::initialize_interpreter();
+        release_main_thread();
     }
     catch (std::runtime_error const &e)
     {
@@ -23,10 +107,131 @@ int32_t initialize_interpreter(LVErrorClusterPtr errorPtr, LVBoolean *alreadyRun
     return 0;
 }
 
+int32_t initialize_interpreter_with_config(LVErrorClusterPtr errorPtr, LVStrArrayHandle preloadModulesHandle, LVStrArrayHandle sysPathAdditionsHandle, LVStrHandle pythonHomeStrHandle, LVBoolean isolated, LVBoolean noSite, LVBoolean *alreadyRunningPtr)
+{
+    try
+    {
+        if (Py_IsInitialized())
+        {
+            *alreadyRunningPtr = LVBooleanTrue;
+            // the configuration only applies to a new interpreter, don't let it be dropped unnoticed
+            bool configured = isolated || noSite || !lvStrHandleToStringView(pythonHomeStrHandle).empty() || !lvStrArrayHandleToStdStrings(preloadModulesHandle).empty() || !lvStrArrayHandleToStdStrings(sysPathAdditionsHandle).empty();
+            return configured ? writeInterpreterConfigIgnoredWarn(errorPtr, __func__) : 0;
+        }
+        auto start = std::chrono::steady_clock::now();
+
+        PyConfig config;
+        if (isolated)
+        {
+            // ignore environment variables and the user site-packages directory
+            PyConfig_InitIsolatedConfig(&config);
+        }
+        else
+        {
+            PyConfig_InitPythonConfig(&config);
+        }
+        config.site_import = noSite ? 0 : 1;
+
+        PyStatus status = PyStatus_Ok();
+        std::string pythonHome = lvStrHandleToStdString(pythonHomeStrHandle);
+        if (!pythonHome.empty())
+        {
+            status = PyConfig_SetBytesString(&config, &config.home, pythonHome.c_str());
+        }
+        if (!PyStatus_Exception(status))
+        {
+            status = Py_InitializeFromConfig(&config);
+        }
+        PyConfig_Clear(&config);
+        if (PyStatus_Exception(status))
+        {
+            throw std::runtime_error(status.err_msg ? status.err_msg : "Python interpreter failed to initialize");
+        }
+
+        {
+            // additions go ahead of the default search path, like PYTHONPATH
+            auto sysPath = pybind11::module_::import("sys").attr("path").cast<pybind11::list>();
+            auto additions = lvStrArrayHandleToStdStrings(sysPathAdditionsHandle);
+            for (size_t i = 0; i < additions.size(); i++)
+            {
+                sysPath.insert(i, pybind11::str(additions[i]));
+            }
+        }
+        release_main_thread();
+
+        std::ostringstream report;
+        report << "interpreter initialize: " << elapsed_ms(start) << " ms\n";
+        start_warmup(lvStrArrayHandleToStdStrings(preloadModulesHandle), report.str());
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, nullptr, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t interpreter_warmup_status(LVErrorClusterPtr errorPtr, int32_t timeoutMs, LVBoolean *readyPtr, LVStrHandlePtr reportStrHandlePtr)
+{
+    try
+    {
+        // no GIL needed here, warmup progress is tracked on the C++ side
+        std::unique_lock lock(warmup.mutex);
+        if (timeoutMs != 0)
+        {
+            auto isReady = []() { return warmup.ready; };
+            if (timeoutMs < 0)
+            {
+                warmup.done.wait(lock, isReady);
+            }
+            else
+            {
+                warmup.done.wait_for(lock, std::chrono::milliseconds(timeoutMs), isReady);
+            }
+        }
+        *readyPtr = warmup.ready ? LVBooleanTrue : LVBooleanFalse;
+        return writeStringToStringHandlePtr(reportStrHandlePtr, warmup.report);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
 int32_t finalize_interpreter(LVErrorClusterPtr errorPtr)
 {
     try
     {
+        // threads started for sessions (event loops, profilers, prefetches) would run into a finalized interpreter
+        for (auto session : snapshotLiveSessions())
+        {
+            session->stopBackgroundThreads();
+        }
+        join_warmup();
+        shutdownParallelMapPool();
+        // a thread state can only be restored on its own thread, LabVIEW may finalize from another one
+        // (or the interpreter was started by someone else), then that thread gets a thread state of its own
+        if (mainThreadState && std::this_thread::get_id() == mainThreadId)
+        {
+            PyEval_RestoreThread(mainThreadState);
+        }
+        else
+        {
+            PyGILState_Ensure();
+        }
+        mainThreadState = nullptr;
         pybind11::finalize_interpreter();
     }
     catch (std::exception const &e)
@@ -38,4 +243,4 @@ int32_t finalize_interpreter(LVErrorClusterPtr errorPtr)
         return writeUnkownErr(errorPtr, __func__);
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,230 @@
+#include <vector>
+
+#include "iterator.hpp"
+#include "lv-array.hpp"
+
+IteratorChunk nextChunk(pybind11::handle iterator)
+{
+    IteratorChunk chunk;
+    try
+    {
+        PyObject *value = PyIter_Next(iterator.ptr());
+        if (value)
+        {
+            chunk.value = pybind11::reinterpret_steal<pybind11::object>(value);
+        }
+        else if (PyErr_Occurred())
+        {
+            throw pybind11::error_already_set();
+        }
+        else
+        {
+            chunk.exhausted = true;
+        }
+    }
+    catch (...)
+    {
+        chunk.error = std::current_exception();
+    }
+    return chunk;
+}
+
+IteratorPrefetches::~IteratorPrefetches()
+{
+    // join() has already been called by destroy_session, this only catches workers started since
+    pybind11::gil_scoped_release release;
+    for (auto &[key, prefetch] : pending)
+    {
+        stopWorker(*prefetch);
+    }
+}
+
+void IteratorPrefetches::work(Session *session, Prefetch *prefetch)
+{
+    std::unique_lock lock(prefetch->mutex);
+    while (true)
+    {
+        prefetch->changed.wait(lock, [prefetch]() { return prefetch->requested || prefetch->stopping; });
+        if (prefetch->stopping)
+        {
+            return;
+        }
+        lock.unlock();
+        {
+            pybind11::gil_scoped_acquire gil;
+            ActiveSessionGuard active(session);
+            auto chunk = nextChunk(prefetch->iterator);
+            // the chunk slot is empty (take() moved it out), so nothing is released under the lock
+            lock.lock();
+            prefetch->chunk = std::move(chunk);
+            prefetch->requested = false;
+            prefetch->ready = true;
+        }
+        prefetch->changed.notify_all();
+    }
+}
+
+void IteratorPrefetches::stopWorker(Prefetch &prefetch)
+{
+    {
+        const std::lock_guard lock(prefetch.mutex);
+        prefetch.stopping = true;
+    }
+    prefetch.changed.notify_all();
+    if (prefetch.thread.joinable())
+    {
+        prefetch.thread.join();
+    }
+}
+
+void IteratorPrefetches::start(Session *session, uint32_t key, pybind11::object iterator)
+{
+    Prefetch *prefetch;
+    {
+        const std::lock_guard lock(mutex);
+        auto &entry = pending[key];
+        if (!entry)
+        {
+            entry = std::make_unique<Prefetch>();
+            entry->iterator = std::move(iterator);
+            entry->thread = std::thread(&IteratorPrefetches::work, session, entry.get());
+        }
+        prefetch = entry.get();
+    }
+    {
+        // a chunk that is already on its way (two calls raced) is left to the next take()
+        const std::lock_guard lock(prefetch->mutex);
+        if (prefetch->requested || prefetch->ready)
+        {
+            return;
+        }
+        prefetch->requested = true;
+    }
+    prefetch->changed.notify_all();
+}
+
+std::optional<IteratorChunk> IteratorPrefetches::take(uint32_t key)
+{
+    Prefetch *prefetch;
+    {
+        const std::lock_guard lock(mutex);
+        auto entry = pending.find(key);
+        if (entry == pending.end())
+        {
+            return std::nullopt;
+        }
+        prefetch = entry->second.get();
+    }
+    {
+        pybind11::gil_scoped_release release;
+        std::unique_lock lock(prefetch->mutex);
+        if (!prefetch->requested && !prefetch->ready)
+        {
+            return std::nullopt;
+        }
+        prefetch->changed.wait(lock, [prefetch]() { return prefetch->ready; });
+    }
+    // moved out with the GIL held again, the worker doesn't touch the chunk until the next request
+    const std::lock_guard lock(prefetch->mutex);
+    prefetch->ready = false;
+    return std::move(prefetch->chunk);
+}
+
+void IteratorPrefetches::discardStale(Session *session)
+{
+    std::vector<std::unique_ptr<Prefetch>> stale;
+    {
+        const std::lock_guard lock(mutex);
+        for (auto entry = pending.begin(); entry != pending.end();)
+        {
+            if (session->isNullObject(entry->first))
+            {
+                stale.push_back(std::move(entry->second));
+                entry = pending.erase(entry);
+            }
+            else
+            {
+                entry++;
+            }
+        }
+    }
+    if (stale.empty())
+    {
+        return;
+    }
+    {
+        pybind11::gil_scoped_release release;
+        for (auto &prefetch : stale)
+        {
+            stopWorker(*prefetch);
+        }
+    }
+    // the iterators and prefetched chunks are released here, with the GIL
+}
+
+void IteratorPrefetches::join()
+{
+    const std::lock_guard lock(mutex);
+    for (auto &[key, prefetch] : pending)
+    {
+        stopWorker(*prefetch);
+    }
+}
+
+int32_t iterator_next_into_array(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef iterator, LVNumericType type, uint8_t ndims, LVBoolean prefetch, LVVoid_t *arrayHandlePtr, LVBoolean *exhaustedPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        ActiveSessionGuard active(session);
+        if (session->isNullObject(iterator))
+        {
+            return writeInvalidPythonObjectRefErr(errorPtr, __func__);
+        }
+        session->prefetches->discardStale(session);
+        auto iteratorObj = session->getObject(iterator);
+        if (!PyIter_Check(iteratorObj.ptr()))
+        {
+            throw std::invalid_argument("The Python object is not an iterator, call iter() on it (or use a generator) first.");
+        }
+
+        // the chunk prefetched by the previous call, if it started one
+        auto prefetched = session->prefetches->take(iterator);
+        IteratorChunk chunk = prefetched ? std::move(*prefetched) : nextChunk(iteratorObj);
+        if (chunk.error)
+        {
+            std::rethrow_exception(chunk.error);
+        }
+        *exhaustedPtr = chunk.exhausted ? LVBooleanTrue : LVBooleanFalse;
+        if (chunk.exhausted)
+        {
+            // the array is left as it is
+            return 0;
+        }
+
+        writeArrayToLVArrayHandlePtr(chunk.value, LVTypeInfo{type, ndims}, arrayHandlePtr);
+        // the next chunk is produced while LabVIEW works on this one, only once it has been copied out
+        // (a generator may reuse the buffer it yielded)
+        if (prefetch)
+        {
+            session->prefetches->start(session, iterator, iteratorObj);
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
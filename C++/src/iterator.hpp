@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <gepit/gepit.hpp>
+
+// outcome of one next() on an iterator
+struct IteratorChunk
+{
+    pybind11::object value;
+    std::exception_ptr error;
+    bool exhausted = false;
+};
+
+// chunks fetched on background threads while LabVIEW works on the previous one, one in flight per iterator
+// every iterator gets one worker thread, started by its first prefetch and kept until the iterator is destroyed
+// python objects in here are only created and released with the GIL held
+class IteratorPrefetches
+{
+private:
+    struct Prefetch
+    {
+        std::thread thread;
+        pybind11::object iterator;
+        // guards the flags and chunk, never held while waiting for the GIL
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool requested = false;
+        bool ready = false;
+        bool stopping = false;
+        IteratorChunk chunk;
+    };
+    std::mutex mutex;
+    // keyed by the object store key of the iterator
+    std::map<uint32_t, std::unique_ptr<Prefetch>> pending;
+
+    static void work(Session *session, Prefetch *prefetch);
+    // ask the worker to finish and join it (GIL released)
+    static void stopWorker(Prefetch &prefetch);
+
+public:
+    ~IteratorPrefetches();
+    // have the iterator's worker fetch its next chunk (GIL held)
+    void start(Session *session, uint32_t key, pybind11::object iterator);
+    // the chunk prefetched for key, waiting for it without the GIL, or nothing if none was started (GIL held)
+    std::optional<IteratorChunk> take(uint32_t key);
+    // finish prefetches of iterators which LabVIEW has destroyed (GIL held)
+    void discardStale(Session *session);
+    // stop every worker, before the session is deleted (GIL released)
+    void join();
+};
+
+// next(iterator) with the GIL held, exceptions are captured rather than thrown
+IteratorChunk nextChunk(pybind11::handle iterator);
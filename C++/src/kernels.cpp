@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+
+#include "kernels.hpp"
+#include "lv-array.hpp"
+
+static std::string_view trim(std::string_view s)
+{
+    constexpr std::string_view space = " \t\r\n";
+    auto first = s.find_first_not_of(space);
+    if (first == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    return s.substr(first, s.find_last_not_of(space) - first + 1);
+}
+
+static std::string_view stripPrefix(std::string_view s, std::string_view prefix)
+{
+    return s.starts_with(prefix) ? trim(s.substr(prefix.length())) : s;
+}
+
+// element types by C / numpy / numba name
+static const std::map<std::string_view, LVNumericType> kernelTypeNames = {
+    {"int8", LVNumericType::I8_ARRAY},
+    {"int16", LVNumericType::I16_ARRAY},
+    {"int32", LVNumericType::I32_ARRAY},
+    {"int", LVNumericType::I32_ARRAY},
+    {"int64", LVNumericType::I64_ARRAY},
+    {"uint8", LVNumericType::U8_ARRAY},
+    {"uint16", LVNumericType::U16_ARRAY},
+    {"uint32", LVNumericType::U32_ARRAY},
+    {"uint64", LVNumericType::U64_ARRAY},
+    {"float32", LVNumericType::SGL_ARRAY},
+    {"float", LVNumericType::SGL_ARRAY},
+    {"float64", LVNumericType::DBL_ARRAY},
+    {"double", LVNumericType::DBL_ARRAY},
+};
+
+static LVNumericType kernelElementType(std::string_view name)
+{
+    name = stripPrefix(name, "const");
+    if (name.ends_with("_t"))
+    {
+        name.remove_suffix(2);
+    }
+    auto match = kernelTypeNames.find(name);
+    if (match == kernelTypeNames.end())
+    {
+        throw std::invalid_argument("Unsupported kernel type \"" + std::string(name) + "\".");
+    }
+    return match->second;
+}
+
+static KernelParam parseKernelParam(std::string_view text)
+{
+    text = trim(text);
+    KernelParam param{false, LVNumericType::DBL_ARRAY, KernelSlot::Word};
+    if (text.ends_with("*"))
+    {
+        text.remove_suffix(1);
+        param.pointer = true;
+    }
+    else if (text.starts_with("CPointer(") && text.ends_with(")"))
+    {
+        text = text.substr(9, text.length() - 10);
+        param.pointer = true;
+    }
+    param.element = kernelElementType(trim(text));
+    if (param.pointer)
+    {
+        return param;
+    }
+
+    switch (param.element)
+    {
+    case LVNumericType::DBL_ARRAY:
+        param.slot = KernelSlot::Real;
+        break;
+    case LVNumericType::SGL_ARRAY:
+        // float arguments are passed differently from doubles on every target, and the registry only has stubs for doubles
+        throw std::invalid_argument("float32 scalar kernel parameters are not supported, use float64 or a float32 pointer.");
+    case LVNumericType::I64_ARRAY:
+    case LVNumericType::U64_ARRAY:
+        param.slot = sizeof(intptr_t) < sizeof(int64_t) ? KernelSlot::Wide : KernelSlot::Word;
+        break;
+    default:
+        param.slot = KernelSlot::Word;
+        break;
+    }
+    return param;
+}
+
+Kernel parseKernelSignature(std::string_view signature)
+{
+    auto text = trim(signature);
+    auto open = text.find('(');
+    if (open == std::string_view::npos || !text.ends_with(")"))
+    {
+        throw std::invalid_argument("Kernel signatures look like \"void(double*, int64, double*)\".");
+    }
+    Kernel kernel{nullptr, KernelReturn::Void, {}, std::string(text), nullptr};
+
+    auto returns = trim(text.substr(0, open));
+    if (returns == "void" || returns == "none")
+    {
+        kernel.returns = KernelReturn::Void;
+    }
+    else if (returns == "int32" || returns == "int" || returns == "int32_t")
+    {
+        kernel.returns = KernelReturn::Int32;
+    }
+    else if (returns == "int64" || returns == "int64_t")
+    {
+        kernel.returns = KernelReturn::Int64;
+    }
+    else if (returns == "float64" || returns == "double")
+    {
+        kernel.returns = KernelReturn::Float64;
+    }
+    else
+    {
+        throw std::invalid_argument("Kernels must return void, int32, int64 or float64, not \"" + std::string(returns) + "\".");
+    }
+
+    auto list = trim(text.substr(open + 1, text.length() - open - 2));
+    if (list == "void")
+    {
+        list = std::string_view();
+    }
+    // numba writes CPointer(float64), whose parentheses don't split parameters
+    size_t depth = 0;
+    size_t start = 0;
+    for (size_t i = 0; !list.empty() && i <= list.length(); i++)
+    {
+        if (i < list.length() && list[i] == '(')
+        {
+            depth++;
+        }
+        else if (i < list.length() && list[i] == ')')
+        {
+            depth--;
+        }
+        else if (i == list.length() || (list[i] == ',' && depth == 0))
+        {
+            kernel.params.push_back(parseKernelParam(list.substr(start, i - start)));
+            start = i + 1;
+        }
+    }
+    if (kernel.params.size() > kernelMaxParams)
+    {
+        throw std::invalid_argument("Kernels can take at most " + std::to_string(kernelMaxParams) + " parameters.");
+    }
+    return kernel;
+}
+
+union KernelValue
+{
+    intptr_t word;
+    int64_t wide;
+    double real;
+};
+
+// call address as R(Passed..., <remaining slots>), picking the C++ type of each parameter from its slot
+template <typename R, typename... Passed>
+static R callWithSlots(void *address, std::span<const KernelParam> params, const KernelValue *values, Passed... passed)
+{
+    constexpr size_t index = sizeof...(Passed);
+    if constexpr (index < kernelMaxParams)
+    {
+        if (index < params.size())
+        {
+            switch (params[index].slot)
+            {
+            case KernelSlot::Real:
+                return callWithSlots<R>(address, params, values, passed..., values[index].real);
+#ifdef _32_BIT_ENV_
+            case KernelSlot::Wide:
+                return callWithSlots<R>(address, params, values, passed..., values[index].wide);
+#endif
+            default:
+                return callWithSlots<R>(address, params, values, passed..., values[index].word);
+            }
+        }
+    }
+    return reinterpret_cast<R (*)(Passed...)>(address)(passed...);
+}
+
+double Kernel::call(LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVDblArrayHandle scalarsHandle) const
+{
+    size_t nargs = argTypesInfoHandle && (*argTypesInfoHandle) ? (*argTypesInfoHandle)->dims[0] : 0;
+    if (nargs != params.size())
+    {
+        throw std::invalid_argument("The kernel " + signature + " takes " + std::to_string(params.size()) + " arguments but " + std::to_string(nargs) + " were supplied.");
+    }
+    auto types = nargs ? std::span{(*argTypesInfoHandle)->data(), nargs} : std::span<LVTypeInfo>();
+    size_t nscalars = scalarsHandle && (*scalarsHandle) ? (*scalarsHandle)->dims[0] : 0;
+    size_t narrays = std::count_if(params.begin(), params.end(), [](const KernelParam &p) { return p.pointer; });
+
+    std::array<KernelValue, kernelMaxParams> values{};
+    size_t slot = 0;
+    for (size_t i = 0; i < params.size(); i++)
+    {
+        const auto &param = params[i];
+        if (param.pointer)
+        {
+            if (types[i].type != param.element)
+            {
+                throw std::invalid_argument("Kernel argument " + std::to_string(i) + " must be an array of the pointer's element type.");
+            }
+            // like call_function, a single array argument is passed as the handle itself rather than a cluster of handles
+            LVVoid_t handle = narrays == 1 ? reinterpret_cast<LVVoid_t>(argsPtr) : argsPtr[slot];
+            slot++;
+            int32_t *dimsPtr = handle ? *reinterpret_cast<int32_t **>(handle) : nullptr;
+            auto offset = visitNumericArrayType(param.element, [&]<typename T>() { return lvArrayDataOffset<T>(types[i].ndims); });
+            values[i].word = dimsPtr ? reinterpret_cast<intptr_t>(reinterpret_cast<uint8_t *>(dimsPtr) + offset) : 0;
+            continue;
+        }
+
+        if (types[i].type != LVNumericType::DBL_SCALAR)
+        {
+            throw std::invalid_argument("Kernel argument " + std::to_string(i) + " is a scalar and must be passed as DBL_SCALAR.");
+        }
+        if (i >= nscalars)
+        {
+            throw std::out_of_range("No scalar value was supplied for kernel argument " + std::to_string(i) + ".");
+        }
+        double scalar = (*scalarsHandle)->data()[i];
+        if (param.slot == KernelSlot::Real)
+        {
+            values[i].real = scalar;
+            continue;
+        }
+        if (!std::isfinite(scalar))
+        {
+            throw std::invalid_argument("Kernel argument " + std::to_string(i) + " is an integer but the scalar supplied is not finite.");
+        }
+        visitNumericArrayType(param.element, [&]<typename T>()
+        {
+            if (param.slot == KernelSlot::Wide)
+            {
+                values[i].wide = static_cast<int64_t>(static_cast<T>(scalar));
+            }
+            else
+            {
+                values[i].word = static_cast<intptr_t>(static_cast<T>(scalar));
+            }
+        });
+    }
+
+    switch (returns)
+    {
+    case KernelReturn::Int32:
+        return callWithSlots<int32_t>(address, params, values.data());
+    case KernelReturn::Int64:
+        return static_cast<double>(callWithSlots<int64_t>(address, params, values.data()));
+    case KernelReturn::Float64:
+        return callWithSlots<double>(address, params, values.data());
+    default:
+        callWithSlots<void>(address, params, values.data());
+        return 0.0;
+    }
+}
+
+void KernelRegistry::add(std::string name, std::shared_ptr<const Kernel> kernel)
+{
+    {
+        const std::lock_guard lock(mutex);
+        std::swap(kernels[std::move(name)], kernel);
+    }
+    // a replaced kernel is released here, outside the lock
+}
+
+bool KernelRegistry::remove(std::string_view name)
+{
+    std::shared_ptr<const Kernel> removed;
+    {
+        const std::lock_guard lock(mutex);
+        auto entry = kernels.find(name);
+        if (entry == kernels.end())
+        {
+            return false;
+        }
+        removed = std::move(entry->second);
+        kernels.erase(entry);
+    }
+    return true;
+}
+
+std::shared_ptr<const Kernel> KernelRegistry::find(std::string_view name)
+{
+    const std::shared_lock lock(mutex);
+    auto entry = kernels.find(name);
+    return entry == kernels.end() ? nullptr : entry->second;
+}
+
+std::vector<std::string> KernelRegistry::names()
+{
+    const std::shared_lock lock(mutex);
+    std::vector<std::string> result;
+    for (const auto &[name, kernel] : kernels)
+    {
+        result.push_back(name);
+    }
+    return result;
+}
+
+static Session *active_session_for_kernels()
+{
+    Session *session = Session::active();
+    if (!session)
+    {
+        throw std::runtime_error("gepit.kernels can only be used from code called through a gepit session");
+    }
+    return session;
+}
+
+static void kernels_register(std::string name, pybind11::object address, std::string signature, pybind11::object owner)
+{
+    auto kernel = std::make_shared<Kernel>(parseKernelSignature(signature));
+
+    // numba cfuncs carry their address, and have to stay alive as long as it is used
+    if (!pybind11::isinstance<pybind11::int_>(address))
+    {
+        if (!pybind11::hasattr(address, "address"))
+        {
+            throw pybind11::type_error("gepit.kernels.register() needs an integer address or an object with an address attribute (numba cfunc)");
+        }
+        if (owner.is_none())
+        {
+            owner = address;
+        }
+        address = address.attr("address");
+    }
+    kernel->address = reinterpret_cast<void *>(address.cast<uintptr_t>());
+    if (!kernel->address)
+    {
+        throw std::invalid_argument("gepit.kernels.register() was given a null function address");
+    }
+    if (!owner.is_none())
+    {
+        kernel->owner = std::shared_ptr<void>(owner.release().ptr(), [](void *ptr)
+        {
+            pybind11::gil_scoped_acquire gil;
+            Py_DECREF(static_cast<PyObject *>(ptr));
+        });
+    }
+    active_session_for_kernels()->kernels->add(std::move(name), std::move(kernel));
+}
+
+static bool kernels_unregister(std::string name)
+{
+    return active_session_for_kernels()->kernels->remove(name);
+}
+
+static pybind11::list kernels_names()
+{
+    pybind11::list names;
+    for (const auto &name : active_session_for_kernels()->kernels->names())
+    {
+        names.append(name);
+    }
+    return names;
+}
+
+// python side: gepit.kernels.register(name, address, signature, owner=None), unregister(name) and names()
+void bind_kernels(pybind11::module_ &m)
+{
+    auto kernels = m.def_submodule("kernels", "Native functions LabVIEW can call without the interpreter");
+    kernels.def("register", &kernels_register, pybind11::arg("name"), pybind11::arg("address"), pybind11::arg("signature"), pybind11::arg("owner") = pybind11::none(),
+                "Register a native function (address or numba cfunc) with a signature like \"void(double*, int64, double*)\"; owner is kept alive while it is registered");
+    kernels.def("unregister", &kernels_unregister, pybind11::arg("name"), "Remove a kernel, returns False if there was none with that name");
+    kernels.def("names", &kernels_names, "Names of the kernels registered in the calling session");
+}
+
+// no GIL: the kernel runs straight on the LabVIEW buffers
+int32_t call_kernel(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle kernelNameStrHandle, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVDblArrayHandle scalarsHandle, double *returnValuePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        auto name = lvStrHandleToStringView(kernelNameStrHandle);
+        auto kernel = session->kernels->find(name);
+        if (!kernel)
+        {
+            throw std::out_of_range("No kernel named \"" + std::string(name) + "\" has been registered with gepit.kernels.register().");
+        }
+        *returnValuePtr = kernel->call(argsPtr, argTypesInfoHandle, scalarsHandle);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
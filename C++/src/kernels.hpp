@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include <gepit/gepit.hpp>
+
+// most parameters a registered kernel can take, each one doubles the call stubs instantiated per return type
+constexpr size_t kernelMaxParams = 6;
+
+// how a parameter is passed to the native function
+// Word is a register-sized integer (pointers and smaller integers), Wide is a 64-bit integer on 32-bit targets
+enum class KernelSlot : uint8_t
+{
+    Word,
+    Wide,
+    Real
+};
+
+enum class KernelReturn : uint8_t
+{
+    Void,
+    Int32,
+    Int64,
+    Float64
+};
+
+struct KernelParam
+{
+    bool pointer;
+    // element type as the LabVIEW array code, pointers match array arguments of this type, scalars come from DBL_SCALAR values
+    LVNumericType element;
+    KernelSlot slot;
+};
+
+// a native function pointer registered from Python (numba @cfunc, cffi, ctypes) with its parsed signature
+struct Kernel
+{
+    void *address;
+    KernelReturn returns;
+    std::vector<KernelParam> params;
+    std::string signature;
+    // python object keeping the code alive, released with the GIL whoever drops the last reference
+    std::shared_ptr<void> owner;
+
+    // call the function on LabVIEW data, no GIL or Python objects involved
+    double call(LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVDblArrayHandle scalarsHandle) const;
+};
+
+// parse "void(double*, int64, double*)" (numba's "none(CPointer(float64), int64, ...)" also works)
+Kernel parseKernelSignature(std::string_view signature);
+
+// kernels registered by the Python code of a session, looked up by name without the GIL
+class KernelRegistry
+{
+private:
+    std::shared_mutex mutex;
+    std::map<std::string, std::shared_ptr<const Kernel>, std::less<>> kernels;
+
+public:
+    void add(std::string name, std::shared_ptr<const Kernel> kernel);
+    bool remove(std::string_view name);
+    std::shared_ptr<const Kernel> find(std::string_view name);
+    std::vector<std::string> names();
+};
+
+void bind_kernels(pybind11::module_ &m);
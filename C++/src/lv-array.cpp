@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "lv-array.hpp"
+#include "tensor-exchange.hpp"
+#include "waveform.hpp"
+
+int32_t lvTypeCode(LVNumericType type)
+{
+    switch (type)
+    {
+    case LVNumericType::I8_ARRAY:
+        return LV_I8_TYPECODE;
+    case LVNumericType::I16_ARRAY:
+        return LV_I16_TYPECODE;
+    case LVNumericType::I32_ARRAY:
+        return LV_I32_TYPECODE;
+    case LVNumericType::I64_ARRAY:
+        return LV_I64_TYPECODE;
+    case LVNumericType::U8_ARRAY:
+        return LV_U8_TYPECODE;
+    case LVNumericType::U16_ARRAY:
+        return LV_U16_TYPECODE;
+    case LVNumericType::U32_ARRAY:
+        return LV_U32_TYPECODE;
+    case LVNumericType::U64_ARRAY:
+        return LV_U64_TYPECODE;
+    case LVNumericType::SGL_ARRAY:
+        return LV_FLOAT_TYPECODE;
+    case LVNumericType::DBL_ARRAY:
+        return LV_DOUBLE_TYPECODE;
+    case LVNumericType::EXT_ARRAY:
+        return LV_EXT_TYPECODE;
+    default:
+        throw std::out_of_range("Non-supported array type.");
+    }
+}
+
+void *resizeLVArrayHandlePtr(LVTypeInfo typeInfo, LVVoid_t *handlePtr, std::span<const pybind11::ssize_t> shape)
+{
+    auto type = lvBaseType(typeInfo.type);
+    size_t ndims = typeInfo.ndims;
+    if (shape.size() != ndims)
+    {
+        throw std::invalid_argument("The shape has " + std::to_string(shape.size()) + " dimensions but the LabVIEW array has " + std::to_string(ndims) + ".");
+    }
+    size_t count = 1;
+    for (auto d : shape)
+    {
+        if (d < 0 || d > std::numeric_limits<int32_t>::max())
+        {
+            throw std::length_error("LabVIEW array dimensions are limited to 2^31-1 elements.");
+        }
+        count *= static_cast<size_t>(d);
+    }
+
+    MgErr err = LVNumericArrayResize(lvTypeCode(type), static_cast<int32_t>(ndims), handlePtr, count);
+    if (err != 0)
+    {
+        throw std::runtime_error("LabVIEW could not resize the array (error " + std::to_string(err) + ").");
+    }
+
+    int32_t *dimsPtr = *reinterpret_cast<int32_t **>(*handlePtr);
+    for (size_t i = 0; i < ndims; i++)
+    {
+        dimsPtr[i] = static_cast<int32_t>(shape[i]);
+    }
+    return visitNumericArrayType(type, [&]<typename T>()
+    {
+        return static_cast<void *>(reinterpret_cast<uint8_t *>(dimsPtr) + lvArrayDataOffset<T>(ndims));
+    });
+}
+
+void writeArrayToLVArrayHandlePtr(pybind11::handle obj, LVTypeInfo typeInfo, LVVoid_t *handlePtr)
+{
+    if (lvIsWaveformType(lvBaseType(typeInfo.type)))
+    {
+        writeWaveformsToLVHandlePtr(obj, handlePtr);
+        return;
+    }
+    auto source = asArrayLike(obj);
+    visitNumericArrayType(lvBaseType(typeInfo.type), [&]<typename T>()
+    {
+        // converts (and casts) only if obj is not already a C-contiguous array of T
+        auto array = pybind11::array_t<T, pybind11::array::c_style | pybind11::array::forcecast>::ensure(source);
+        if (!array)
+        {
+            throw std::invalid_argument("The Python object cannot be converted to an array of the requested type.");
+        }
+        if (static_cast<size_t>(array.ndim()) != typeInfo.ndims)
+        {
+            throw std::invalid_argument("The Python array has " + std::to_string(array.ndim()) + " dimensions but the LabVIEW array has " + std::to_string(typeInfo.ndims) + ".");
+        }
+        void *data = resizeLVArrayHandlePtr(typeInfo, handlePtr, std::span<const pybind11::ssize_t>(array.shape(), array.ndim()));
+        std::memcpy(data, array.data(), array.size() * sizeof(T));
+    });
+}
+
+pybind11::array regionView(pybind11::array view, const LVArrayRegion &region)
+{
+    auto ndim = view.ndim();
+    if (ndim > static_cast<pybind11::ssize_t>(std::size(region.start)))
+    {
+        throw std::invalid_argument("Array regions are limited to " + std::to_string(std::size(region.start)) + " dimensions.");
+    }
+
+    auto data = static_cast<const uint8_t *>(view.data());
+    std::vector<pybind11::ssize_t> shape;
+    std::vector<pybind11::ssize_t> strides;
+    for (pybind11::ssize_t i = 0; i < ndim; i++)
+    {
+        pybind11::ssize_t extent = view.shape(i);
+        pybind11::ssize_t start = region.start[i];
+        if (start < 0 || start > extent)
+        {
+            throw std::out_of_range("Region start " + std::to_string(start) + " is outside dimension " + std::to_string(i) + " (size " + std::to_string(extent) + ").");
+        }
+        // like Array Subset, a count past the end is clipped
+        pybind11::ssize_t count = region.count[i] > 0 ? std::min<pybind11::ssize_t>(region.count[i], extent - start) : extent - start;
+        pybind11::ssize_t step = region.step[i] > 0 ? region.step[i] : 1;
+
+        data += start * view.strides(i);
+        shape.push_back((count + step - 1) / step);
+        strides.push_back(view.strides(i) * step);
+    }
+    if (region.fortranOrder)
+    {
+        std::reverse(shape.begin(), shape.end());
+        std::reverse(strides.begin(), strides.end());
+    }
+    // the view is the base, so the region inherits its flags and keeps it alive
+    return pybind11::array(view.dtype(), shape, strides, data, view);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <gepit/gepit.hpp>
+
+// call f.template operator()<T>() with the C++ element type of a LabVIEW numeric array type
+template <typename F>
+decltype(auto) visitNumericArrayType(LVNumericType type, F &&f)
+{
+    switch (type)
+    {
+    case LVNumericType::I8_ARRAY:
+        return f.template operator()<int8_t>();
+    case LVNumericType::I16_ARRAY:
+        return f.template operator()<int16_t>();
+    case LVNumericType::I32_ARRAY:
+        return f.template operator()<int32_t>();
+    case LVNumericType::I64_ARRAY:
+        return f.template operator()<int64_t>();
+    case LVNumericType::U8_ARRAY:
+        return f.template operator()<uint8_t>();
+    case LVNumericType::U16_ARRAY:
+        return f.template operator()<uint16_t>();
+    case LVNumericType::U32_ARRAY:
+        return f.template operator()<uint32_t>();
+    case LVNumericType::U64_ARRAY:
+        return f.template operator()<uint64_t>();
+    case LVNumericType::SGL_ARRAY:
+        return f.template operator()<float>();
+    case LVNumericType::DBL_ARRAY:
+        return f.template operator()<double>();
+    case LVNumericType::EXT_ARRAY:
+        return f.template operator()<long double>();
+    default:
+        throw std::out_of_range("Non-supported array type.");
+    }
+}
+
+// LabVIEW NumericArrayResize type code for the element type of a numeric array type
+int32_t lvTypeCode(LVNumericType type);
+
+// byte offset from the start of an array handle's data (its dims) to the first element
+// 64-bit LabVIEW aligns the elements to their alignment (at most 8 bytes), 32-bit LabVIEW packs them
+template <typename T>
+constexpr size_t lvArrayDataOffset(size_t ndims)
+{
+    size_t offset = ndims * sizeof(int32_t);
+#ifndef _32_BIT_ENV_
+    constexpr size_t alignment = alignof(T) < 8 ? alignof(T) : 8;
+    offset = (offset + alignment - 1) / alignment * alignment;
+#endif
+    return offset;
+}
+
+// resize the LabVIEW array handle at handlePtr to shape (C order) and return a pointer to its (uninitialised) elements
+void *resizeLVArrayHandlePtr(LVTypeInfo typeInfo, LVVoid_t *handlePtr, std::span<const pybind11::ssize_t> shape);
+
+// resize the LabVIEW array handle at handlePtr to the shape of obj (anything numpy can convert, or a DLPack/Arrow producer)
+// and copy its elements into it, casting to the array's element type
+void writeArrayToLVArrayHandlePtr(pybind11::handle obj, LVTypeInfo typeInfo, LVVoid_t *handlePtr);
+
+// strided view of a region of a numpy view of a LabVIEW array, sharing its memory
+pybind11::array regionView(pybind11::array view, const LVArrayRegion &region);
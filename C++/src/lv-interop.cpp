@@ -1,58 +1,111 @@
+#include <limits>
+
 #include "gepit/lv-interop.hpp"
 
-MgErr LVNumericArrayResize(int32_t typeCode, int32_t numDims, void *handle, size_t size)
+// the LabVIEW development environment or run-time engine the DLL has been loaded into
+static HMODULE lvModuleHandle()
 {
-    if (numericArrayResizeImp == nullptr)
+    auto lvModule = GetModuleHandle("LabVIEW.exe");
+    if (lvModule == nullptr)
     {
-        // import function
-        auto lvModule = GetModuleHandle("LabVIEW.exe");
-        if (lvModule == nullptr)
-        {
-            lvModule = GetModuleHandle("lvffrt.dll");
-        }
-        if (lvModule == nullptr)
-        {
-            lvModule = GetModuleHandle("lvrt.dll");
-        }
-        numericArrayResizeImp = (numericArrayResizePtr)GetProcAddress(lvModule, "NumericArrayResize");
+        lvModule = GetModuleHandle("lvffrt.dll");
+    }
+    if (lvModule == nullptr)
+    {
+        lvModule = GetModuleHandle("lvrt.dll");
     }
+    return lvModule;
+}
+
+// define the numericArrayResize function pointer type
+using numericArrayResizePtr = std::add_pointer<MgErr(int32_t, int32_t, void *handle, size_t size)>::type;
+
+MgErr LVNumericArrayResize(int32_t typeCode, int32_t numDims, void *handle, size_t size)
+{
+    // import function (function-local statics are initialised exactly once, even with concurrent callers)
+    static const auto numericArrayResizeImp = (numericArrayResizePtr)GetProcAddress(lvModuleHandle(), "NumericArrayResize");
 
     return numericArrayResizeImp(typeCode, numDims, handle, size);
 }
 
-MgErr writeStringToStringHandlePtr(LVStrHandlePtr handlePtr, std::string s)
+using postLVUserEventPtr = std::add_pointer<MgErr(LVUserEventRef, void *)>::type;
+
+MgErr LVPostUserEvent(LVUserEventRef ref, void *data)
+{
+    static const auto postLVUserEventImp = (postLVUserEventPtr)GetProcAddress(lvModuleHandle(), "PostLVUserEvent");
+
+    return postLVUserEventImp(ref, data);
+}
+
+// grow a string handle (if needed) so it can hold length bytes
+static MgErr reserveStringHandlePtr(LVStrHandlePtr handlePtr, size_t length)
 {
+    // the length is stored in an int32
+    if (length > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+    {
+        return LV_MFULL_ERR;
+    }
     size_t currentSize = (*handlePtr) && (**handlePtr) ? (**handlePtr)->cnt : 0;
-    if (s.length() > currentSize)
+    if (length > currentSize)
     {
-        auto result = LVNumericArrayResize(LV_U8_TYPECODE, 1, handlePtr, s.length());
-        if (result != 0)
-        {
-            return result;
-        }
+        return LVNumericArrayResize(LV_U8_TYPECODE, 1, handlePtr, length);
+    }
+    return 0;
+}
+
+MgErr writeStringToStringHandlePtr(LVStrHandlePtr handlePtr, std::string_view s)
+{
+    auto result = reserveStringHandlePtr(handlePtr, s.length());
+    if (result != 0)
+    {
+        return result;
     }
-    std::memcpy((**handlePtr)->str, s.c_str(), s.length());
-    (**handlePtr)->cnt = s.length();
+    std::memcpy((**handlePtr)->str, s.data(), s.length());
+    (**handlePtr)->cnt = static_cast<int32_t>(s.length());
 
     return 0;
 }
 
 // write to an LabVIEW Error
-MgErr writeErrorToErrorClusterPtr(LVErrorClusterPtr errorPtr, int32_t code, std::string func, std::string message)
+MgErr writeErrorToErrorClusterPtr(LVErrorClusterPtr errorPtr, int32_t code, std::string_view func, std::string_view message)
 {
     // set status and code
     errorPtr->status = code != 0 ? LVBooleanTrue : LVBooleanFalse;
     errorPtr->code = code;
 
-    // build outputString
-    std::string outputString = "" + func + "()" + (message.empty() ? "" : ("\n<ERR>" + message));
+    // source is "func()" followed by "\n<ERR>message" when there is a message
+    // the parts are copied straight into the handle, no intermediate string is built
+    constexpr std::string_view callSuffix = "()";
+    constexpr std::string_view messagePrefix = "\n<ERR>";
+    size_t length = func.length() + callSuffix.length() + (message.empty() ? 0 : messagePrefix.length() + message.length());
 
-    // write outputString to error source string handle
-    return writeStringToStringHandlePtr(&(errorPtr->source), outputString);
+    LVStrHandlePtr handlePtr = &(errorPtr->source);
+    auto result = reserveStringHandlePtr(handlePtr, length);
+    if (result != 0)
+    {
+        return result;
+    }
+
+    uint8_t *out = (**handlePtr)->str;
+    for (auto part : {func, callSuffix, message.empty() ? std::string_view() : messagePrefix, message})
+    {
+        if (!part.empty())
+        {
+            std::memcpy(out, part.data(), part.length());
+            out += part.length();
+        }
+    }
+    (**handlePtr)->cnt = static_cast<int32_t>(length);
+
+    return 0;
 }
 
 
 std::string lvStrHandleToStdString(LVStrHandle handle){
-    size_t length = handle && (*handle) ? (*handle)->cnt : 0;
-    return std::string(reinterpret_cast<char*>((*handle)->str), length);
+    if (!handle || !(*handle))
+    {
+        // LabVIEW passes empty strings as NULL handles
+        return std::string();
+    }
+    return std::string(reinterpret_cast<char*>((*handle)->str), (*handle)->cnt);
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+#include "call-function.hpp"
+#include "lv-array.hpp"
+#include "mapped-array.hpp"
+#include "watch.hpp"
+
+MappedFile::MappedFile(std::string path, LVNumericType type, std::vector<int64_t> rowShape, pybind11::dtype dtype, uint64_t capacityRows)
+    : file(INVALID_HANDLE_VALUE), mapping(nullptr), base(nullptr), header(nullptr), path(std::move(path)), type(type), rowShape(std::move(rowShape))
+{
+    if (this->rowShape.size() > mappedFileMaxRowDims)
+    {
+        throw std::invalid_argument("Mapped arrays are limited to " + std::to_string(mappedFileMaxRowDims + 1) + " dimensions.");
+    }
+    rowBytes = dtype.itemsize();
+    for (auto d : this->rowShape)
+    {
+        if (d <= 0)
+        {
+            throw std::invalid_argument("Mapped array row dimensions must be positive.");
+        }
+        if (static_cast<uint64_t>(d) > std::numeric_limits<size_t>::max() / rowBytes)
+        {
+            throw std::length_error("The mapped array rows are too large.");
+        }
+        rowBytes *= static_cast<size_t>(d);
+    }
+    if (capacityRows > (std::numeric_limits<uint64_t>::max() - mappedFileDataOffset) / rowBytes)
+    {
+        throw std::length_error("A mapped array of " + std::to_string(capacityRows) + " rows of " + std::to_string(rowBytes) + " bytes is too large.");
+    }
+    uint64_t size = mappedFileDataOffset + capacityRows * rowBytes;
+    // the whole file is mapped as one view, a 32-bit process can't address more than SIZE_MAX bytes
+    if (size > SIZE_MAX)
+    {
+        throw std::length_error("A mapped array of " + std::to_string(size) + " bytes does not fit in the address space of this process.");
+    }
+
+    file = CreateFileA(this->path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Could not create the mapped file " + this->path + " (Windows error " + std::to_string(GetLastError()) + ").");
+    }
+    // mapping a new file at its full size extends it, the pages are only backed by disk once touched
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    if (mapping)
+    {
+        base = static_cast<uint8_t *>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(size)));
+    }
+    if (!base)
+    {
+        auto err = GetLastError();
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("Could not map " + std::to_string(size) + " bytes of " + this->path + " (Windows error " + std::to_string(err) + ").");
+    }
+
+    header = reinterpret_cast<MappedFileHeader *>(base);
+    std::memcpy(header->magic, "GEPITMAP", sizeof(header->magic));
+    header->version = 1;
+    header->ndims = static_cast<uint32_t>(this->rowShape.size() + 1);
+    auto dtypeStr = dtype.attr("str").cast<std::string>();
+    std::strncpy(header->dtype, dtypeStr.c_str(), sizeof(header->dtype));
+    header->dataOffset = mappedFileDataOffset;
+    header->capacityRows = capacityRows;
+    header->rows = 0;
+    std::copy(this->rowShape.begin(), this->rowShape.end(), header->rowShape);
+}
+
+MappedFile::~MappedFile()
+{
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+    CloseHandle(file);
+}
+
+uint64_t MappedFile::rows() const
+{
+    return std::atomic_ref<uint64_t>(header->rows).load(std::memory_order_acquire);
+}
+
+uint64_t MappedFile::capacity() const
+{
+    return header->capacityRows;
+}
+
+void MappedFile::appendRows(const uint8_t *data, uint64_t nrows)
+{
+    {
+        // one writer at a time, readers only look at the rows counter
+        const std::lock_guard lock(mutex);
+        uint64_t current = header->rows;
+        if (nrows > header->capacityRows - current)
+        {
+            throw std::length_error("The mapped file has room for " + std::to_string(header->capacityRows - current) + " more rows but " + std::to_string(nrows) + " were written.");
+        }
+        std::memcpy(base + mappedFileDataOffset + current * rowBytes, data, nrows * rowBytes);
+        std::atomic_ref<uint64_t>(header->rows).store(current + nrows, std::memory_order_release);
+    }
+    rowsAdded.notify_all();
+}
+
+uint64_t MappedFile::waitForRows(uint64_t after, std::chrono::milliseconds timeout)
+{
+    std::unique_lock lock(mutex);
+    auto more = [this, after]() { return header->rows > after; };
+    if (timeout.count() < 0)
+    {
+        rowsAdded.wait(lock, more);
+    }
+    else
+    {
+        rowsAdded.wait_for(lock, timeout, more);
+    }
+    return header->rows;
+}
+
+pybind11::array MappedFile::view(uint64_t start, uint64_t stop)
+{
+    uint64_t written = rows();
+    stop = std::min(stop, written);
+    start = std::min(start, stop);
+
+    std::vector<pybind11::ssize_t> shape{static_cast<pybind11::ssize_t>(stop - start)};
+    shape.insert(shape.end(), rowShape.begin(), rowShape.end());
+    auto dtype = visitNumericArrayType(type, []<typename T>() { return create_dtype<T>(); });
+
+    // the capsule holds a reference to the mapping for as long as numpy uses the view
+    auto owner = new std::shared_ptr<MappedFile>(shared_from_this());
+    pybind11::capsule keepAlive(owner, [](void *ptr) { delete static_cast<std::shared_ptr<MappedFile> *>(ptr); });
+    return pybind11::array(dtype, shape, base + mappedFileDataOffset + start * rowBytes, keepAlive);
+}
+
+MappedArray::MappedArray(std::shared_ptr<MappedFile> file, std::string scopeName) : file(std::move(file)), scopeName(std::move(scopeName))
+{
+    // nothing else to construct
+}
+
+// numpy.memmap of the rows written so far to a file created by create_mapped_array (from any process)
+static pybind11::object open_mapped_array(std::string path, std::string mode)
+{
+    MappedFileHeader header;
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.read(reinterpret_cast<char *>(&header), sizeof(header)) || std::memcmp(header.magic, "GEPITMAP", sizeof(header.magic)) != 0)
+    {
+        throw std::invalid_argument(path + " is not a gepit mapped array file.");
+    }
+    pybind11::tuple shape(header.ndims);
+    shape[0] = header.rows;
+    for (uint32_t i = 1; i < header.ndims; i++)
+    {
+        shape[i] = header.rowShape[i - 1];
+    }
+    std::string dtype(header.dtype, strnlen(header.dtype, sizeof(header.dtype)));
+    return pybind11::module_::import("numpy").attr("memmap")(path, pybind11::arg("dtype") = dtype, pybind11::arg("mode") = mode,
+                                                            pybind11::arg("offset") = header.dataOffset, pybind11::arg("shape") = shape);
+}
+
+// python side: gepit.MappedArray objects published in the scope by create_mapped_array and gepit.open_mapped_array
+void bind_mapped_array(pybind11::module_ &m)
+{
+    pybind11::class_<MappedFile, std::shared_ptr<MappedFile>>(m, "MappedArray", "File-backed array LabVIEW appends rows to")
+        .def_property_readonly("rows", &MappedFile::rows, "Number of rows written so far")
+        .def_property_readonly("capacity", &MappedFile::capacity, "Number of rows the file has room for")
+        .def_readonly("path", &MappedFile::path)
+        .def("view", [](MappedFile &self, uint64_t start, pybind11::object stop)
+             { return self.view(start, stop.is_none() ? UINT64_MAX : stop.cast<uint64_t>()); },
+             pybind11::arg("start") = 0, pybind11::arg("stop") = pybind11::none(),
+             "Zero-copy ndarray of the written rows [start, stop)")
+        .def("wait", [](MappedFile &self, uint64_t after, pybind11::object timeout)
+             {
+                 auto timeoutMs = std::chrono::milliseconds(timeout.is_none() ? -1 : static_cast<int64_t>(timeout.cast<double>() * 1000));
+                 pybind11::gil_scoped_release release;
+                 return self.waitForRows(after, timeoutMs);
+             },
+             pybind11::arg("after"), pybind11::arg("timeout") = pybind11::none(),
+             "Block until more than after rows have been written (or timeout seconds pass), returns the row count")
+        .def("__array__", [](MappedFile &self, pybind11::args, pybind11::kwargs)
+             { return self.view(0, UINT64_MAX); })
+        .def("__len__", &MappedFile::rows);
+    m.def("open_mapped_array", &open_mapped_array, pybind11::arg("path"), pybind11::arg("mode") = "r",
+          "numpy.memmap of the rows written so far to a gepit mapped array file");
+}
+
+int32_t create_mapped_array(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle pathStrHandle, LVStrHandle scopeNameStrHandle, LVNumericType type, LVI32ArrayHandle rowShapeHandle, uint64_t capacityRows, MappedArrayHandlePtr mappedArrayPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        std::vector<int64_t> rowShape;
+        size_t nRowDims = rowShapeHandle && (*rowShapeHandle) ? (*rowShapeHandle)->dims[0] : 0;
+        for (size_t i = 0; i < nRowDims; i++)
+        {
+            rowShape.push_back((*rowShapeHandle)->data()[i]);
+        }
+        auto dtype = visitNumericArrayType(type, []<typename T>() { return create_dtype<T>(); });
+        auto file = std::make_shared<MappedFile>(lvStrHandleToStdString(pathStrHandle), type, rowShape, dtype, capacityRows);
+
+        auto mappedArray = std::make_unique<MappedArray>(file, lvStrHandleToStdString(scopeNameStrHandle));
+        session->scope[session->internName(mappedArray->scopeName)] = file;
+        *mappedArrayPtr = mappedArray.release();
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t destroy_mapped_array(LVErrorClusterPtr errorPtr, SessionHandle session, MappedArrayHandle mappedArray)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!mappedArray)
+    {
+        return writeInvalidMappedArrayHandleErr(errorPtr, __func__);
+    }
+    // python may still hold views, the file is unmapped when the last of them goes
+    delete mappedArray;
+    return 0;
+}
+
+// no GIL: LabVIEW can stream rows in while Python code is running
+int32_t write_mapped_array_rows(LVErrorClusterPtr errorPtr, SessionHandle session, MappedArrayHandle mappedArray, LVNumericType type, LVVoid_t arrayHandle, uint64_t *rowsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!mappedArray)
+    {
+        return writeInvalidMappedArrayHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        auto &file = *mappedArray->file;
+        // the bytes are copied as they are, so they have to be of the type the file was created with
+        if (lvBaseType(type) != file.type)
+        {
+            throw std::invalid_argument("The LabVIEW array type (" + std::to_string(lvBaseType(type)) + ") does not match the type the mapped array was created with (" + std::to_string(file.type) + ").");
+        }
+        size_t ndims = file.rowShape.size() + 1;
+        // arrayHandle must be an array of the mapped type with one more dimension than the rows
+        int32_t *dimsPtr = arrayHandle ? *reinterpret_cast<int32_t **>(arrayHandle) : nullptr;
+        if (dimsPtr)
+        {
+            for (size_t i = 1; i < ndims; i++)
+            {
+                if (dimsPtr[i] != file.rowShape[i - 1])
+                {
+                    throw std::invalid_argument("Dimension " + std::to_string(i) + " of the LabVIEW array (" + std::to_string(dimsPtr[i]) + ") does not match the mapped rows (" + std::to_string(file.rowShape[i - 1]) + ").");
+                }
+            }
+            auto dataOffset = visitNumericArrayType(file.type, [ndims]<typename T>() { return lvArrayDataOffset<T>(ndims); });
+            file.appendRows(reinterpret_cast<const uint8_t *>(dimsPtr) + dataOffset, dimsPtr[0]);
+            session->watches->notify({mappedArray->scopeName});
+        }
+        *rowsPtr = file.rows();
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
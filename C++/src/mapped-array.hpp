@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gepit/gepit.hpp>
+
+constexpr size_t mappedFileMaxRowDims = 7;
+
+// file layout: this header, then rows of row-major elements starting at dataOffset
+// other processes can open the file with numpy.memmap(path, dtype, offset=dataOffset, shape=(rows, *rowShape))
+struct MappedFileHeader
+{
+    char magic[8]; // "GEPITMAP"
+    uint32_t version;
+    uint32_t ndims; // including the row dimension
+    char dtype[8];  // numpy dtype string, e.g. "<f8"
+    uint64_t dataOffset;
+    uint64_t capacityRows;
+    uint64_t rows; // rows written so far, only bumped once their data is in place
+    int64_t rowShape[mappedFileMaxRowDims];
+};
+
+constexpr size_t mappedFileDataOffset = 4096;
+static_assert(sizeof(MappedFileHeader) <= mappedFileDataOffset);
+
+// a preallocated file mapped into memory which LabVIEW appends rows to and Python reads in place
+class MappedFile : public std::enable_shared_from_this<MappedFile>
+{
+private:
+    HANDLE file;
+    HANDLE mapping;
+    uint8_t *base;
+    MappedFileHeader *header;
+    size_t rowBytes;
+    std::mutex mutex;
+    std::condition_variable rowsAdded;
+
+public:
+    const std::string path;
+    const LVNumericType type;
+    const std::vector<int64_t> rowShape;
+
+    MappedFile(std::string path, LVNumericType type, std::vector<int64_t> rowShape, pybind11::dtype dtype, uint64_t capacityRows);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    uint64_t rows() const;
+    uint64_t capacity() const;
+    void appendRows(const uint8_t *data, uint64_t nrows);
+    // block (without the GIL) until more than after rows have been written or the timeout expires
+    uint64_t waitForRows(uint64_t after, std::chrono::milliseconds timeout);
+    // numpy view of rows [start, stop), keeping the mapping alive
+    pybind11::array view(uint64_t start, uint64_t stop);
+};
+
+// what LabVIEW holds: the mapping plus the scope variable it is published under
+class MappedArray
+{
+public:
+    const std::shared_ptr<MappedFile> file;
+    const std::string scopeName;
+
+    MappedArray(std::shared_ptr<MappedFile> file, std::string scopeName);
+};
+
+void bind_mapped_array(pybind11::module_ &m);
@@ -0,0 +1,257 @@
+#include <cstring>
+#include <iterator>
+#include <span>
+
+#include "lv-array.hpp"
+#include "memo-cache.hpp"
+#include "waveform.hpp"
+
+// the 64-bit primes and round of xxHash
+constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t prime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+static uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t mixRound(uint64_t acc, uint64_t input)
+{
+    acc += input * prime2;
+    acc = rotl(acc, 31);
+    return acc * prime1;
+}
+
+static uint64_t avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t load64(const uint8_t *p)
+{
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+ContentHasher::ContentHasher() : state{prime5, prime4}
+{
+    // nothing else to construct
+}
+
+void ContentHasher::update(const void *data, size_t bytes)
+{
+    auto p = static_cast<const uint8_t *>(data);
+    // the lanes don't depend on each other, so the compiler can keep all four multiplies in flight
+    uint64_t lanes[4] = {state.low + prime1 + prime2, state.high + prime2, state.low, state.high - prime1};
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32)
+    {
+        lanes[0] = mixRound(lanes[0], load64(p + i));
+        lanes[1] = mixRound(lanes[1], load64(p + i + 8));
+        lanes[2] = mixRound(lanes[2], load64(p + i + 16));
+        lanes[3] = mixRound(lanes[3], load64(p + i + 24));
+    }
+    uint64_t tail = bytes * prime5;
+    for (; i + 8 <= bytes; i += 8)
+    {
+        tail = rotl(tail ^ mixRound(0, load64(p + i)), 27) * prime1 + prime4;
+    }
+    if (i < bytes)
+    {
+        uint64_t last = 0;
+        std::memcpy(&last, p + i, bytes - i);
+        tail = rotl(tail ^ mixRound(0, last), 27) * prime1 + prime4;
+    }
+    // two different combinations of the lanes make the two halves
+    uint64_t a = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+    uint64_t b = rotl(lanes[0], 18) + rotl(lanes[1], 12) + rotl(lanes[2], 7) + rotl(lanes[3], 1);
+    state.low = avalanche(a ^ tail);
+    state.high = avalanche(b + mixRound(tail, a));
+}
+
+Hash128 ContentHasher::digest() const
+{
+    return state;
+}
+
+MemoCache::MemoCache() : maxBytes(0), bytes(0), stats{}
+{
+    // disabled until configure_call_site_memo
+}
+
+bool MemoCache::enabled()
+{
+    const std::lock_guard lock(mutex);
+    return maxBytes > 0;
+}
+
+// caller holds the mutex
+void MemoCache::trim(std::list<Entry> &evicted)
+{
+    while (!entries.empty() && bytes > maxBytes)
+    {
+        auto oldest = std::prev(entries.end());
+        index.erase(oldest->hash);
+        bytes -= oldest->bytes;
+        evicted.splice(evicted.end(), entries, oldest);
+        stats.evicted++;
+    }
+}
+
+void MemoCache::configure(size_t maxBytes)
+{
+    // declared before the lock, so the evicted results are released after it
+    std::list<Entry> evicted;
+    const std::lock_guard lock(mutex);
+    this->maxBytes = maxBytes;
+    trim(evicted);
+}
+
+MemoKey MemoCache::key(SessionHandle session, pybind11::handle fn, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle)
+{
+    MemoKey key;
+    ContentHasher hasher;
+    uint64_t hashedBytes = 0;
+
+    // methods are bound anew on every lookup, their instance and function identify them
+    key.pinned.push_back(pybind11::reinterpret_borrow<pybind11::object>(fn));
+    if (PyMethod_Check(fn.ptr()))
+    {
+        hasher.update(reinterpret_cast<uintptr_t>(PyMethod_GET_SELF(fn.ptr())));
+        hasher.update(reinterpret_cast<uintptr_t>(PyMethod_GET_FUNCTION(fn.ptr())));
+    }
+    else
+    {
+        hasher.update(reinterpret_cast<uintptr_t>(fn.ptr()));
+    }
+
+    size_t nargs = argTypesInfoHandle && (*argTypesInfoHandle) && (*argTypesInfoHandle)->dims ? (*argTypesInfoHandle)->dims[0] : 0;
+    size_t nregions = argRegionsHandle && (*argRegionsHandle) ? (*argRegionsHandle)->dims[0] : 0;
+    for (size_t i = 0; i < nargs; i++)
+    {
+        auto typeInfo = (*argTypesInfoHandle)->data()[i];
+        // a single argument is passed as the handle itself rather than a cluster of handles
+        LVVoid_t handle = nargs == 1 ? reinterpret_cast<LVVoid_t>(argsPtr) : argsPtr[i];
+        hasher.update(typeInfo.type);
+        hasher.update(typeInfo.ndims);
+        if (i < nregions)
+        {
+            const auto &region = (*argRegionsHandle)->data()[i];
+            hasher.update(region.start);
+            hasher.update(region.count);
+            hasher.update(region.step);
+            hasher.update(region.fortranOrder);
+        }
+
+        auto type = lvBaseType(typeInfo.type);
+        if (type == LVNumericType::PYOBJ)
+        {
+            auto obj = session->getObject(handle);
+            hasher.update(reinterpret_cast<uintptr_t>(obj.ptr()));
+            key.pinned.push_back(std::move(obj));
+            continue;
+        }
+        if (lvIsWaveformType(type))
+        {
+            auto waveforms = reinterpret_cast<LVWaveformDBLArrayHandle>(handle);
+            size_t count = waveforms && *waveforms ? (*waveforms)->dims[0] : 0;
+            hasher.update(count);
+            for (size_t w = 0; w < count; w++)
+            {
+                const auto &waveform = (*waveforms)->data()[w];
+                size_t samples = waveform.Y && *waveform.Y ? (*waveform.Y)->dims[0] : 0;
+                hasher.update(waveform.t0);
+                hasher.update(waveform.dt);
+                hasher.update(samples);
+                if (samples > 0)
+                {
+                    hasher.update((*waveform.Y)->data(), samples * sizeof(double));
+                }
+                hashedBytes += samples * sizeof(double);
+            }
+            continue;
+        }
+        size_t ndims = lvDims(typeInfo.ndims);
+        visitNumericArrayType(type, [&]<typename T>()
+        {
+            int32_t *dimsPtr = *(reinterpret_cast<int32_t **>(handle));
+            size_t count = 1;
+            for (const auto &d : std::span<int32_t>(dimsPtr, ndims))
+            {
+                count *= d > 0 ? static_cast<size_t>(d) : 0;
+            }
+            hasher.update(dimsPtr, ndims * sizeof(int32_t));
+            hasher.update(reinterpret_cast<uint8_t *>(dimsPtr) + lvArrayDataOffset<T>(ndims), count * sizeof(T));
+            hashedBytes += count * sizeof(T);
+        });
+    }
+
+    key.hash = hasher.digest();
+    const std::lock_guard lock(mutex);
+    stats.hashedBytes += hashedBytes;
+    return key;
+}
+
+std::optional<pybind11::object> MemoCache::find(const MemoKey &key)
+{
+    const std::lock_guard lock(mutex);
+    auto match = index.find(key.hash);
+    if (match == index.end())
+    {
+        stats.misses++;
+        return std::nullopt;
+    }
+    stats.hits++;
+    entries.splice(entries.begin(), entries, match->second);
+    return match->second->result;
+}
+
+// estimated memory held by a cached result
+static size_t resultBytes(pybind11::handle result)
+{
+    if (pybind11::isinstance<pybind11::array>(result))
+    {
+        return static_cast<size_t>(result.cast<pybind11::array>().nbytes());
+    }
+    return pybind11::module_::import("sys").attr("getsizeof")(result).cast<size_t>();
+}
+
+void MemoCache::insert(MemoKey key, pybind11::object result)
+{
+    size_t entryBytes = resultBytes(result) + sizeof(Entry);
+    std::list<Entry> evicted;
+    const std::lock_guard lock(mutex);
+    // a result bigger than the whole cache would only evict everything else
+    if (entryBytes > maxBytes || index.contains(key.hash))
+    {
+        return;
+    }
+    entries.push_front(Entry{key.hash, std::move(result), std::move(key.pinned), entryBytes});
+    index[key.hash] = entries.begin();
+    bytes += entryBytes;
+    trim(evicted);
+}
+
+LVMemoStats MemoCache::getStats()
+{
+    const std::lock_guard lock(mutex);
+    LVMemoStats current = stats;
+    current.entries = entries.size();
+    current.bytes = bytes;
+    return current;
+}
+
+void MemoCache::resetStats()
+{
+    const std::lock_guard lock(mutex);
+    stats = LVMemoStats{};
+}
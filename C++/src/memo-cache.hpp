@@ -0,0 +1,83 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <gepit/gepit.hpp>
+
+// 128-bit content hash, wide enough that a collision between two argument sets is not a practical concern
+struct Hash128
+{
+    uint64_t low;
+    uint64_t high;
+    bool operator==(const Hash128 &other) const = default;
+};
+
+// hash of a sequence of buffers and values, each buffer is hashed in 32-byte stripes over 4 independent lanes
+class ContentHasher
+{
+private:
+    Hash128 state;
+
+public:
+    ContentHasher();
+    void update(const void *data, size_t bytes);
+    template <typename T>
+    void update(const T &value)
+    {
+        update(&value, sizeof(T));
+    }
+    Hash128 digest() const;
+};
+
+// the hash of a call's arguments, and the objects the hash refers to by identity
+// the objects are kept alive with a cached result, so their addresses can't be reused by other objects
+struct MemoKey
+{
+    Hash128 hash;
+    std::vector<pybind11::object> pinned;
+};
+
+// results of a call site's calls keyed by the content of their arguments, evicting the least recently used
+// results once they take more than maxBytes; a limit of 0 turns memoization off
+class MemoCache
+{
+private:
+    struct Entry
+    {
+        Hash128 hash;
+        pybind11::object result;
+        std::vector<pybind11::object> pinned;
+        size_t bytes;
+    };
+    struct HashOf
+    {
+        size_t operator()(const Hash128 &hash) const { return static_cast<size_t>(hash.low); }
+    };
+    std::mutex mutex;
+    // most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<Hash128, std::list<Entry>::iterator, HashOf> index;
+    size_t maxBytes;
+    size_t bytes;
+    LVMemoStats stats;
+
+    // unlink the least recently used entries until the cache is within maxBytes, they are released by the caller
+    void trim(std::list<Entry> &evicted);
+
+public:
+    MemoCache();
+    bool enabled();
+    // change the limit, evicting what no longer fits (GIL held)
+    void configure(size_t maxBytes);
+    // hash the arguments of a call to fn (GIL held), array contents are hashed, stored objects by identity
+    MemoKey key(SessionHandle session, pybind11::handle fn, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVArgumentRegionHandle argRegionsHandle);
+    // the cached result for key, counted as a hit or miss (GIL held)
+    std::optional<pybind11::object> find(const MemoKey &key);
+    void insert(MemoKey key, pybind11::object result);
+    LVMemoStats getStats();
+    void resetStats();
+};
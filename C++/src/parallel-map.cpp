@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "call-function.hpp"
+#include "lv-array.hpp"
+#include "parallel-map.hpp"
+#include "tensor-exchange.hpp"
+
+uint64_t ChunkRange::pack(uint32_t begin, uint32_t end)
+{
+    return (static_cast<uint64_t>(begin) << 32) | end;
+}
+
+void ChunkRange::assign(uint32_t begin, uint32_t end)
+{
+    range.store(pack(begin, end), std::memory_order_release);
+}
+
+uint32_t ChunkRange::remaining() const
+{
+    uint64_t current = range.load(std::memory_order_relaxed);
+    uint32_t begin = static_cast<uint32_t>(current >> 32);
+    uint32_t end = static_cast<uint32_t>(current);
+    return begin < end ? end - begin : 0;
+}
+
+bool ChunkRange::popFront(uint32_t &chunk)
+{
+    uint64_t current = range.load(std::memory_order_acquire);
+    while (true)
+    {
+        uint32_t begin = static_cast<uint32_t>(current >> 32);
+        uint32_t end = static_cast<uint32_t>(current);
+        if (begin >= end)
+        {
+            return false;
+        }
+        if (range.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            chunk = begin;
+            return true;
+        }
+    }
+}
+
+bool ChunkRange::stealBack(uint32_t &stolenBegin, uint32_t &stolenEnd)
+{
+    uint64_t current = range.load(std::memory_order_acquire);
+    while (true)
+    {
+        uint32_t begin = static_cast<uint32_t>(current >> 32);
+        uint32_t end = static_cast<uint32_t>(current);
+        if (begin >= end)
+        {
+            return false;
+        }
+        // a single remaining chunk is taken whole
+        uint32_t middle = begin + (end - begin) / 2;
+        if (range.compare_exchange_weak(current, pack(begin, middle), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            stolenBegin = middle;
+            stolenEnd = end;
+            return true;
+        }
+    }
+}
+
+ParallelMapPool::ParallelMapPool() : job(nullptr), generation(0), participants(0), running(0), stopping(false)
+{
+    // threads are started by the first run that needs them
+}
+
+ParallelMapPool::~ParallelMapPool()
+{
+    // only reached at unload without finalize_interpreter, when the threads can no longer be joined
+    for (auto &thread : threads)
+    {
+        thread.detach();
+    }
+}
+
+void ParallelMapPool::workerLoop(size_t index, uint64_t seen)
+{
+    // register with the interpreter once, gil_scoped_acquire finds this thread state for every chunk
+    PyGILState_STATE gilState = PyGILState_Ensure();
+    PyThreadState *threadState = PyEval_SaveThread();
+
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping)
+        {
+            break;
+        }
+        seen = generation;
+        if (index >= participants)
+        {
+            continue;
+        }
+        auto current = job;
+        lock.unlock();
+        (*current)(index);
+        lock.lock();
+        if (--running == 0)
+        {
+            finished.notify_all();
+        }
+    }
+    lock.unlock();
+
+    PyEval_RestoreThread(threadState);
+    PyGILState_Release(gilState);
+}
+
+void ParallelMapPool::run(size_t n, const std::function<void(size_t)> &fn)
+{
+    const std::lock_guard serial(runMutex);
+    std::unique_lock lock(mutex);
+    while (threads.size() + 1 < n)
+    {
+        threads.emplace_back(&ParallelMapPool::workerLoop, this, threads.size() + 1, generation);
+    }
+    job = &fn;
+    participants = n;
+    running = n - 1;
+    generation++;
+    lock.unlock();
+    wake.notify_all();
+
+    fn(0);
+
+    lock.lock();
+    finished.wait(lock, [&]() { return running == 0; });
+    job = nullptr;
+}
+
+void ParallelMapPool::shutdown()
+{
+    const std::lock_guard serial(runMutex);
+    {
+        const std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+    stopping = false;
+}
+
+static ParallelMapPool parallelMapPool;
+
+void shutdownParallelMapPool()
+{
+    parallelMapPool.shutdown();
+}
+
+// view of elements [begin, end) of array along axis, sharing its memory (GIL held)
+static pybind11::array axisSlice(const pybind11::array &array, pybind11::ssize_t axis, pybind11::ssize_t begin, pybind11::ssize_t end)
+{
+    std::vector<pybind11::ssize_t> shape(array.shape(), array.shape() + array.ndim());
+    std::vector<pybind11::ssize_t> strides(array.strides(), array.strides() + array.ndim());
+    shape[axis] = end - begin;
+    auto data = static_cast<const uint8_t *>(array.data()) + begin * strides[axis];
+    return pybind11::array(array.dtype(), shape, strides, data, array);
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int32_t call_function_parallel_map(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandle fnNameStrHandle, LVVoid_t inputHandle, LVNumericType inputType, uint8_t ndims, int32_t axis, uint32_t chunkBytes, int32_t nThreads, LVNumericType outputType, uint8_t outputNdims, LVVoid_t *outputHandlePtr, LVParallelMapStatsPtr statsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto start = std::chrono::steady_clock::now();
+        ActiveSessionGuard active(session);
+        if (lvArgumentMode(inputType) != NUMPY_MODE)
+        {
+            throw std::invalid_argument("The parallel map input is passed to Python as numpy views, argument modes can't be used.");
+        }
+        auto input = pybind11::array::ensure(convertHandleToPythonObject(session, inputHandle, LVTypeInfo{inputType, ndims}));
+        if (!input)
+        {
+            throw std::invalid_argument("The parallel map input must be an array.");
+        }
+        pybind11::ssize_t inputAxis = axis < 0 ? axis + input.ndim() : axis;
+        if (inputAxis < 0 || inputAxis >= input.ndim())
+        {
+            throw std::out_of_range("The parallel map axis is out of range for the input array.");
+        }
+
+        // chunks are whole rows along the axis, at least one row each
+        pybind11::ssize_t length = input.shape(inputAxis);
+        size_t rowBytes = input.itemsize();
+        for (pybind11::ssize_t d = 0; d < input.ndim(); d++)
+        {
+            rowBytes *= d == inputAxis ? 1 : static_cast<size_t>(input.shape(d));
+        }
+        size_t targetBytes = chunkBytes ? chunkBytes : defaultParallelMapChunkBytes;
+        auto chunkRows = static_cast<pybind11::ssize_t>(std::max<size_t>(1, targetBytes / std::max<size_t>(1, rowBytes)));
+        size_t nChunks = std::max<size_t>(1, (length + chunkRows - 1) / chunkRows);
+        if (nChunks > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::length_error("The parallel map input splits into too many chunks, use a larger chunk size.");
+        }
+        auto chunkBounds = [&](size_t chunk)
+        {
+            auto begin = static_cast<pybind11::ssize_t>(chunk) * chunkRows;
+            return std::make_pair(begin, std::min(begin + chunkRows, length));
+        };
+
+        pybind11::object fn = session->scope[lvStrHandleToPyStr(fnNameStrHandle)];
+        pybind11::object copyto = pybind11::module_::import("numpy").attr("copyto");
+
+        // every result must have the output's dimensions, and across the map axis the shape of the first one
+        // (numpy.copyto would broadcast a mismatched result over the output rather than fail)
+        std::vector<pybind11::ssize_t> outputShape;
+        auto chunkResult = [&](pybind11::handle result, pybind11::ssize_t begin, pybind11::ssize_t end)
+        {
+            auto array = pybind11::array::ensure(asArrayLike(result));
+            bool matches = array && array.ndim() == outputNdims && inputAxis < array.ndim() && array.shape(inputAxis) == end - begin;
+            for (pybind11::ssize_t d = 0; matches && d < static_cast<pybind11::ssize_t>(outputShape.size()); d++)
+            {
+                matches = d == inputAxis || array.shape(d) == outputShape[d];
+            }
+            if (!matches)
+            {
+                throw std::invalid_argument("The function must return an array with " + std::to_string(outputNdims) + " dimensions, whose length along the map axis matches that of its input chunk and whose other dimensions are the same for every chunk (rows " + std::to_string(begin) + " to " + std::to_string(end) + ").");
+            }
+            return array;
+        };
+
+        // the first chunk runs on this thread and gives the shape of the output
+        auto chunkStart = std::chrono::steady_clock::now();
+        auto [firstBegin, firstEnd] = chunkBounds(0);
+        auto first = chunkResult(fn(axisSlice(input, inputAxis, firstBegin, firstEnd)), firstBegin, firstEnd);
+        outputShape.assign(first.shape(), first.shape() + first.ndim());
+        outputShape[inputAxis] = length;
+        LVTypeInfo outputTypeInfo{lvBaseType(outputType), outputNdims};
+        resizeLVArrayHandlePtr(outputTypeInfo, outputHandlePtr, outputShape);
+        auto output = convertHandleToPythonObject(session, *outputHandlePtr, outputTypeInfo).cast<pybind11::array>();
+        copyto(axisSlice(output, inputAxis, firstBegin, firstEnd), first, pybind11::arg("casting") = "unsafe");
+        std::atomic<uint64_t> chunkNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - chunkStart).count();
+
+        // the remaining chunks are dealt out in contiguous blocks, threads that run dry steal half of the fullest block
+        size_t remainingChunks = nChunks - 1;
+        size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        size_t nWorkers = std::min<size_t>(nThreads > 0 ? nThreads : hardwareThreads, remainingChunks);
+        std::atomic<uint64_t> steals = 0;
+        std::exception_ptr chunkError;
+        if (nWorkers > 0)
+        {
+            auto ranges = std::make_unique<ChunkRange[]>(nWorkers);
+            for (size_t i = 0; i < nWorkers; i++)
+            {
+                ranges[i].assign(static_cast<uint32_t>(1 + i * remainingChunks / nWorkers), static_cast<uint32_t>(1 + (i + 1) * remainingChunks / nWorkers));
+            }
+            std::atomic<bool> failed = false;
+            std::mutex errorMutex;
+
+            auto steal = [&](size_t self)
+            {
+                while (true)
+                {
+                    size_t victim = nWorkers;
+                    uint32_t most = 0;
+                    for (size_t i = 0; i < nWorkers; i++)
+                    {
+                        uint32_t count = i == self ? 0 : ranges[i].remaining();
+                        if (count > most)
+                        {
+                            most = count;
+                            victim = i;
+                        }
+                    }
+                    if (victim == nWorkers)
+                    {
+                        return false;
+                    }
+                    uint32_t begin, end;
+                    if (ranges[victim].stealBack(begin, end))
+                    {
+                        ranges[self].assign(begin, end);
+                        steals++;
+                        return true;
+                    }
+                }
+            };
+
+            std::function<void(size_t)> job = [&](size_t self)
+            {
+                uint32_t chunk;
+                while (!failed.load(std::memory_order_relaxed))
+                {
+                    if (!ranges[self].popFront(chunk))
+                    {
+                        if (!steal(self))
+                        {
+                            return;
+                        }
+                        continue;
+                    }
+                    {
+                        // the GIL is only held while Python runs, numpy releases it inside most array operations
+                        pybind11::gil_scoped_acquire chunkGil;
+                        // timed from here, the wait for the GIL isn't work on the chunk
+                        auto chunkStart = std::chrono::steady_clock::now();
+                        try
+                        {
+                            ActiveSessionGuard chunkActive(session);
+                            auto [begin, end] = chunkBounds(chunk);
+                            auto result = chunkResult(fn(axisSlice(input, inputAxis, begin, end)), begin, end);
+                            copyto(axisSlice(output, inputAxis, begin, end), result, pybind11::arg("casting") = "unsafe");
+                        }
+                        catch (...)
+                        {
+                            const std::lock_guard lock(errorMutex);
+                            if (!chunkError)
+                            {
+                                chunkError = std::current_exception();
+                            }
+                            failed = true;
+                        }
+                        chunkNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - chunkStart).count();
+                    }
+                }
+            };
+
+            pybind11::gil_scoped_release release;
+            parallelMapPool.run(nWorkers, job);
+        }
+        if (chunkError)
+        {
+            std::rethrow_exception(chunkError);
+        }
+
+        if (statsPtr)
+        {
+            *statsPtr = {static_cast<uint32_t>(nChunks), static_cast<uint32_t>(std::max<size_t>(1, nWorkers)), steals.load(), elapsed_ms(start), chunkNs.load() / 1e6};
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
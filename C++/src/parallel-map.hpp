@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <gepit/gepit.hpp>
+
+// chunk size used when call_function_parallel_map is passed 0, small enough for a chunk and its result to stay in L2
+constexpr size_t defaultParallelMapChunkBytes = 256 * 1024;
+
+// range of chunk indices [begin, end) owned by one thread, packed into one word so it can be updated with a single CAS
+// the owner takes chunks from the front, idle threads steal the back half
+struct alignas(64) ChunkRange
+{
+    std::atomic<uint64_t> range{0};
+
+    static uint64_t pack(uint32_t begin, uint32_t end);
+    void assign(uint32_t begin, uint32_t end);
+    uint32_t remaining() const;
+    bool popFront(uint32_t &chunk);
+    bool stealBack(uint32_t &begin, uint32_t &end);
+};
+
+// threads kept around between parallel maps, each registered with the interpreter once (it keeps its thread state)
+class ParallelMapPool
+{
+private:
+    // one map at a time, later callers wait
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::vector<std::thread> threads;
+    const std::function<void(size_t)> *job;
+    uint64_t generation;
+    size_t participants;
+    size_t running;
+    bool stopping;
+
+    void workerLoop(size_t index, uint64_t seen);
+
+public:
+    ParallelMapPool();
+    ~ParallelMapPool();
+    // run job(0) on the calling thread and job(1) .. job(n - 1) on pool threads, job must not throw (GIL released)
+    void run(size_t n, const std::function<void(size_t)> &job);
+    // join the threads, called before the interpreter is finalized (GIL released)
+    void shutdown();
+};
+
+void shutdownParallelMapPool();
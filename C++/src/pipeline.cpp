@@ -0,0 +1,255 @@
+#include <chrono>
+#include <span>
+
+#include "pipeline.hpp"
+
+Pipeline::Pipeline(uint32_t nInputs) : slotAssigned(nInputs, true), nInputs(nInputs)
+{
+    busy.clear();
+}
+
+void Pipeline::addStage(pybind11::object fn, std::vector<uint32_t> inputSlots, int32_t outputSlot)
+{
+    for (auto slot : inputSlots)
+    {
+        if (slot >= slotAssigned.size() || !slotAssigned[slot])
+        {
+            throw std::out_of_range("Pipeline stage input slot " + std::to_string(slot) + " is not a pipeline input or the output of an earlier stage.");
+        }
+    }
+    if (outputSlot >= 0)
+    {
+        if (static_cast<uint32_t>(outputSlot) < nInputs)
+        {
+            throw std::out_of_range("Pipeline stage output slot " + std::to_string(outputSlot) + " would overwrite a pipeline input.");
+        }
+        if (static_cast<uint32_t>(outputSlot) >= maxSlots)
+        {
+            throw std::out_of_range("Pipeline stage output slot " + std::to_string(outputSlot) + " is too large, a pipeline has at most " + std::to_string(maxSlots) + " slots.");
+        }
+        if (static_cast<size_t>(outputSlot) >= slotAssigned.size())
+        {
+            slotAssigned.resize(outputSlot + 1, false);
+        }
+        slotAssigned[outputSlot] = true;
+    }
+    stages.push_back(Stage{fn, std::move(inputSlots), outputSlot});
+}
+
+pybind11::object Pipeline::run(SessionHandle session, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, uint32_t resultSlot, std::vector<double> &stageTimesMs)
+{
+    if (resultSlot >= slotAssigned.size() || !slotAssigned[resultSlot])
+    {
+        throw std::out_of_range("Pipeline result slot " + std::to_string(resultSlot) + " is never assigned.");
+    }
+    // inputs are views of LabVIEW memory, a stored reference to one would outlive the call
+    if (resultSlot < nInputs)
+    {
+        throw std::out_of_range("Pipeline result slot " + std::to_string(resultSlot) + " is a pipeline input, the result must be the output of a stage.");
+    }
+    if (busy.test_and_set())
+    {
+        // another thread is part way through a run of this pipeline
+        std::vector<pybind11::object> ownSlots;
+        std::vector<pybind11::object> ownArgs;
+        std::vector<PyObject *> ownPointers;
+        return runWith(session, argsPtr, argTypesInfoHandle, resultSlot, stageTimesMs, ownSlots, ownArgs, ownPointers);
+    }
+
+    struct Release
+    {
+        Pipeline *pipeline;
+        ~Release()
+        {
+            pipeline->argObjects.clear(); // keeps capacity
+            pipeline->busy.clear();
+        }
+    } release{this};
+
+    return runWith(session, argsPtr, argTypesInfoHandle, resultSlot, stageTimesMs, slots, argObjects, argPointers);
+}
+
+pybind11::object Pipeline::runWith(SessionHandle session, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, uint32_t resultSlot, std::vector<double> &stageTimesMs,
+                                   std::vector<pybind11::object> &callSlots, std::vector<pybind11::object> &callArgs, std::vector<PyObject *> &callPointers)
+{
+    // drop every slot afterwards, the inputs are views of LabVIEW memory which is only valid during this call
+    struct ClearSlots
+    {
+        std::vector<pybind11::object> &slots;
+        ~ClearSlots()
+        {
+            for (auto &slot : slots)
+            {
+                slot = pybind11::object();
+            }
+        }
+    } clearSlots{callSlots};
+
+    callSlots.resize(slotAssigned.size());
+    callArgs.clear();
+    convertArgsToPythonObjects(session, argsPtr, argTypesInfoHandle, callArgs);
+    if (callArgs.size() != nInputs)
+    {
+        throw std::out_of_range("The pipeline expects " + std::to_string(nInputs) + " inputs but " + std::to_string(callArgs.size()) + " were supplied.");
+    }
+    std::move(callArgs.begin(), callArgs.end(), callSlots.begin());
+
+    stageTimesMs.clear();
+    // stages added while this runs (the GIL is released during the calls) may move the vector, so it is indexed every time
+    size_t nStages = stages.size();
+    for (size_t s = 0; s < nStages; s++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        callArgs.clear();
+        for (auto slot : stages[s].inputSlots)
+        {
+            callArgs.push_back(callSlots[slot]);
+        }
+        pybind11::object fn = stages[s].fn;
+        auto result = vectorcallWithArgs(fn, callArgs, pybind11::handle(), callPointers);
+        if (stages[s].outputSlot >= 0)
+        {
+            callSlots[stages[s].outputSlot] = std::move(result);
+        }
+
+        stageTimesMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    callArgs.clear();
+
+    return callSlots[resultSlot];
+}
+
+int32_t create_pipeline(LVErrorClusterPtr errorPtr, SessionHandle session, uint32_t nInputs, PipelineHandlePtr pipelinePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        if (nInputs > Pipeline::maxSlots)
+        {
+            throw std::out_of_range("A pipeline has at most " + std::to_string(Pipeline::maxSlots) + " slots, it can't have " + std::to_string(nInputs) + " inputs.");
+        }
+        *pipelinePtr = new Pipeline(nInputs);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t destroy_pipeline(LVErrorClusterPtr errorPtr, SessionHandle session, PipelineHandle pipeline)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!pipeline)
+    {
+        return writeInvalidPipelineHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        delete pipeline;
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t add_pipeline_stage(LVErrorClusterPtr errorPtr, SessionHandle session, PipelineHandle pipeline, LVPythonObjRef classInstance, LVStrHandle fnNameStrHandle, LVI32ArrayHandle inputSlotsHandle, int32_t outputSlot)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!pipeline)
+    {
+        return writeInvalidPipelineHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        std::vector<uint32_t> inputSlots;
+        if (inputSlotsHandle && *inputSlotsHandle)
+        {
+            for (auto slot : std::span((*inputSlotsHandle)->data(), (*inputSlotsHandle)->dims[0]))
+            {
+                if (slot < 0)
+                {
+                    throw std::out_of_range("Pipeline stage input slots must not be negative.");
+                }
+                inputSlots.push_back(slot);
+            }
+        }
+        // resolved once here, a method keeps its instance alive even if LabVIEW destroys the reference
+        pipeline->addStage(resolveCallable(session, classInstance, lvStrHandleToPyStr(fnNameStrHandle)), std::move(inputSlots), outputSlot);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t run_pipeline(LVErrorClusterPtr errorPtr, SessionHandle session, PipelineHandle pipeline, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, uint32_t resultSlot, LVPythonObjRef *returnObjectPtr, LVDblArrayHandle *stageTimesHandlePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!pipeline)
+    {
+        return writeInvalidPipelineHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        ActiveSessionGuard active(session);
+        ArgumentCopyBack copyBack;
+        std::vector<double> stageTimesMs;
+        auto result = pipeline->run(session, argsPtr, argTypesInfoHandle, resultSlot, stageTimesMs);
+        copyBack.finish();
+        *returnObjectPtr = session->keepObject(std::move(result));
+        return writeDoublesToDblArrayHandlePtr(stageTimesHandlePtr, stageTimesMs);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "call-function.hpp"
+
+// a small graph of calls run in a single DLL call
+// slots 0..nInputs-1 hold the LabVIEW arguments, every stage reads its inputs from slots and
+// writes its result to a slot, intermediates stay as Python objects and never reach the object store
+class Pipeline
+{
+private:
+    struct Stage
+    {
+        pybind11::object fn;
+        std::vector<uint32_t> inputSlots;
+        int32_t outputSlot; // negative to discard the result
+    };
+    std::vector<Stage> stages;
+    std::vector<bool> slotAssigned;
+    // set while a run is using the buffers below, a concurrent run falls back to its own
+    std::atomic_flag busy;
+    std::vector<pybind11::object> slots;
+    std::vector<pybind11::object> argObjects;
+    std::vector<PyObject *> argPointers;
+
+    pybind11::object runWith(SessionHandle session, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, uint32_t resultSlot, std::vector<double> &stageTimesMs,
+                             std::vector<pybind11::object> &callSlots, std::vector<pybind11::object> &callArgs, std::vector<PyObject *> &callPointers);
+
+public:
+    // inputs and stage outputs together, slot numbers are indexes into a vector
+    static constexpr uint32_t maxSlots = 1 << 16;
+    const uint32_t nInputs;
+
+    explicit Pipeline(uint32_t nInputs);
+    // stages run in the order they are added, so inputs must be pipeline inputs or outputs of earlier stages
+    void addStage(pybind11::object fn, std::vector<uint32_t> inputSlots, int32_t outputSlot);
+    // returns the value of resultSlot (a stage output, not an input), stageTimesMs receives the duration of each stage
+    pybind11::object run(SessionHandle session, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, uint32_t resultSlot, std::vector<double> &stageTimesMs);
+};
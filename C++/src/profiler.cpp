@@ -0,0 +1,205 @@
+#include <filesystem>
+#include <sstream>
+
+#include "profiler.hpp"
+
+Profiler::Profiler(std::chrono::microseconds interval) : running(true), interval(interval)
+{
+    sampler = std::thread(&Profiler::run, this);
+}
+
+Profiler::~Profiler()
+{
+    stop();
+}
+
+void Profiler::stop()
+{
+    running = false;
+    wake.notify_all();
+    if (sampler.joinable())
+    {
+        sampler.join();
+    }
+}
+
+void Profiler::run()
+{
+    pybind11::gil_scoped_acquire gil;
+    // an exception must not leave this thread, the stacks sampled so far are kept and sampling ends
+    try
+    {
+        while (running)
+        {
+            {
+                pybind11::gil_scoped_release nogil;
+                std::unique_lock lock(mutex);
+                wake.wait_for(lock, interval, [this]() { return !running; });
+            }
+            if (running)
+            {
+                sample();
+            }
+        }
+    }
+    catch (std::exception const &e)
+    {
+        const std::lock_guard lock(mutex);
+        error = e.what();
+    }
+    catch (...)
+    {
+        const std::lock_guard lock(mutex);
+        error = "unknown error";
+    }
+}
+
+// names that can't be encoded (lone surrogates) show as "?" rather than ending the sample
+static std::string utf8_or_placeholder(PyObject *text)
+{
+    const char *utf8 = PyUnicode_AsUTF8(text);
+    if (!utf8)
+    {
+        PyErr_Clear();
+        return "?";
+    }
+    return utf8;
+}
+
+// "function (file.py:line)" for a frame
+static std::string frame_label(PyFrameObject *frame)
+{
+    PyCodeObject *code = PyFrame_GetCode(frame);
+    std::string label = utf8_or_placeholder(code->co_name);
+    label += " (";
+    label += std::filesystem::path(utf8_or_placeholder(code->co_filename)).filename().string();
+    label += ":" + std::to_string(PyFrame_GetLineNumber(frame)) + ")";
+    Py_DECREF(code);
+    return label;
+}
+
+// record the stack of every thread currently executing Python code (caller holds the GIL)
+void Profiler::sample()
+{
+    auto frames = pybind11::module_::import("sys").attr("_current_frames")().cast<pybind11::dict>();
+    auto samplerId = PyThread_get_thread_ident();
+
+    for (auto item : frames)
+    {
+        if (item.first.cast<unsigned long>() == samplerId)
+        {
+            continue;
+        }
+
+        // walk from the leaf to the root, then join root-first
+        std::vector<std::string> labels;
+        PyFrameObject *frame = reinterpret_cast<PyFrameObject *>(item.second.ptr());
+        Py_INCREF(frame);
+        while (frame)
+        {
+            labels.push_back(frame_label(frame));
+            PyFrameObject *back = PyFrame_GetBack(frame);
+            Py_DECREF(frame);
+            frame = back;
+        }
+
+        std::string stack;
+        for (auto it = labels.rbegin(); it != labels.rend(); it++)
+        {
+            if (!stack.empty())
+            {
+                stack += ';';
+            }
+            stack += *it;
+        }
+
+        const std::lock_guard lock(mutex);
+        stacks[stack]++;
+    }
+}
+
+std::string Profiler::samplingError()
+{
+    const std::lock_guard lock(mutex);
+    return error;
+}
+
+std::string Profiler::collapsedStacks()
+{
+    const std::lock_guard lock(mutex);
+    std::ostringstream out;
+    for (const auto &[stack, count] : stacks)
+    {
+        out << stack << ' ' << count << '\n';
+    }
+    return out.str();
+}
+
+int32_t start_profiling(LVErrorClusterPtr errorPtr, SessionHandle session, int32_t intervalUs)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        const std::lock_guard lock(session->backgroundMutex);
+        if (session->profiler)
+        {
+            throw std::logic_error("Profiling is already running for this session.");
+        }
+        if (intervalUs <= 0)
+        {
+            throw std::invalid_argument("The profiling interval must be positive.");
+        }
+        session->profiler = std::make_shared<Profiler>(std::chrono::microseconds(intervalUs));
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t stop_profiling(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHandlePtr collapsedStacksStrHandlePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        std::shared_ptr<Profiler> profiler;
+        {
+            const std::lock_guard lock(session->backgroundMutex);
+            profiler = std::move(session->profiler);
+        }
+        if (!profiler)
+        {
+            throw std::logic_error("Profiling was not started for this session.");
+        }
+        // no GIL here, the sampler thread needs it to finish its last sample
+        profiler->stop();
+        MgErr err = writeStringToStringHandlePtr(collapsedStacksStrHandlePtr, profiler->collapsedStacks());
+        // the stacks sampled before the error are still returned
+        auto error = profiler->samplingError();
+        if (err == 0 && !error.empty())
+        {
+            throw std::runtime_error("Sampling stopped early: " + error);
+        }
+        return err;
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <gepit/gepit.hpp>
+
+// samples the Python stacks of all interpreter threads at a fixed interval
+// and aggregates them as collapsed stacks ("outer;inner;leaf count") for flame-graph tools
+// it is started through a session but samples the whole interpreter, other sessions' threads included
+// the sampler only needs the GIL briefly, when the running thread hands it over at the switch interval
+class Profiler
+{
+private:
+    std::thread sampler;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> running;
+    std::chrono::microseconds interval;
+    std::unordered_map<std::string, uint64_t> stacks;
+    // why sampling ended early (empty while it is running or after a clean stop)
+    std::string error;
+
+    void run();
+    void sample();
+
+public:
+    explicit Profiler(std::chrono::microseconds interval);
+    ~Profiler();
+    // stopping joins the sampler thread, it must not be called while holding the GIL
+    void stop();
+    std::string collapsedStacks();
+    std::string samplingError();
+};
@@ -1,7 +1,11 @@
 #include <algorithm>
 #include <functional>
 
+#include "call-function.hpp"
+#include "lv-array.hpp"
 #include "py-object.hpp"
+#include "tensor-exchange.hpp"
+#include "summary.hpp"
 
 int32_t destroy_py_object(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object)
 {
@@ -9,13 +13,14 @@ int32_t destroy_py_object(LVErrorClusterPtr errorPtr, SessionHandle session, LVP
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         session->dropObject(object);
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -34,13 +39,14 @@ int32_t create_py_object_int(LVErrorClusterPtr errorPtr, SessionHandle session,
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         *returnObjectPtr = session->keepObject(pybind11::int_(value));
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -60,6 +66,7 @@ int32_t create_py_object_IMAQ(LVErrorClusterPtr errorPtr, SessionHandle session,
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         std::vector<pybind11::ssize_t> shape;
@@ -105,7 +112,7 @@ int32_t create_py_object_IMAQ(LVErrorClusterPtr errorPtr, SessionHandle session,
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -124,6 +131,7 @@ int32_t cast_py_object_to_int(LVErrorClusterPtr errorPtr, SessionHandle session,
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         if (session->isNullObject(object))
@@ -134,7 +142,7 @@ int32_t cast_py_object_to_int(LVErrorClusterPtr errorPtr, SessionHandle session,
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -153,6 +161,7 @@ int32_t cast_py_object_to_dbl(LVErrorClusterPtr errorPtr, SessionHandle session,
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         if (session->isNullObject(object))
@@ -163,7 +172,69 @@ int32_t cast_py_object_to_dbl(LVErrorClusterPtr errorPtr, SessionHandle session,
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t cast_py_object_to_array(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, LVNumericType type, uint8_t ndims, LVVoid_t *arrayHandlePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        if (session->isNullObject(object))
+        {
+            return writeInvalidPythonObjectRefErr(errorPtr, __func__);
+        }
+        writeArrayToLVArrayHandlePtr(session->getObject(object), LVTypeInfo{type, ndims}, arrayHandlePtr);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t cast_py_object_to_array_region(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, LVNumericType type, uint8_t ndims, LVArrayRegionPtr regionPtr, LVVoid_t arrayHandle)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        if (session->isNullObject(object))
+        {
+            return writeInvalidPythonObjectRefErr(errorPtr, __func__);
+        }
+        // scatter into the existing array, which keeps its size
+        auto target = convertHandleToPythonObject(session, arrayHandle, LVTypeInfo{lvBaseType(type), ndims}, regionPtr);
+        pybind11::module_::import("numpy").attr("copyto")(target, asArrayLike(session->getObject(object)), pybind11::arg("casting") = "unsafe");
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -182,6 +253,7 @@ int32_t cast_py_object_to_string(LVErrorClusterPtr errorPtr, SessionHandle sessi
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         if (session->isNullObject(object))
@@ -192,7 +264,7 @@ int32_t cast_py_object_to_string(LVErrorClusterPtr errorPtr, SessionHandle sessi
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -211,17 +283,18 @@ int32_t py_object_print_to_str(LVErrorClusterPtr errorPtr, SessionHandle session
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         if (session->isNullObject(object))
         {
             return writeInvalidPythonObjectRefErr(errorPtr, __func__);
         }
-        writeStringToStringHandlePtr(strHandlePtr, pybind11::str(session->getObject(object)));
+        writeStringToStringHandlePtr(strHandlePtr, pybind11::str(session->getObject(object)).cast<std::string>());
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -232,4 +305,34 @@ int32_t py_object_print_to_str(LVErrorClusterPtr errorPtr, SessionHandle session
         return writeUnkownErr(errorPtr, __func__);
     }
     return 0;
-}
\ No newline at end of file
+}
+
+int32_t py_object_print_to_str_bounded(LVErrorClusterPtr errorPtr, SessionHandle session, LVPythonObjRef object, int32_t maxLength, int32_t maxItems, LVStrHandlePtr strHandlePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        if (session->isNullObject(object))
+        {
+            return writeInvalidPythonObjectRefErr(errorPtr, __func__);
+        }
+        writeStringToStringHandlePtr(strHandlePtr, boundedRepr(session->getObject(object), std::max(maxLength, 0), std::max(maxItems, 0)));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <mutex>
+
+#include "call-site.hpp"
+#include "realtime.hpp"
+
+LatencyHistogram::LatencyHistogram()
+{
+    clear();
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t ns)
+{
+    if (ns < subBuckets)
+    {
+        return ns;
+    }
+    size_t msb = std::bit_width(ns) - 1; // >= 4
+    size_t sub = (ns >> (msb - 4)) & (subBuckets - 1);
+    return (msb - 3) * subBuckets + sub;
+}
+
+uint64_t LatencyHistogram::upperBoundOf(size_t bucket)
+{
+    if (bucket < subBuckets)
+    {
+        return bucket;
+    }
+    size_t msb = bucket / subBuckets + 3;
+    uint64_t sub = bucket % subBuckets;
+    return ((subBuckets + sub + 1) << (msb - 4)) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    uint64_t ns = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+    const std::lock_guard lock(mutex);
+    counts[bucketOf(ns)]++;
+    total++;
+    sumNs += ns;
+    maxNs = std::max(maxNs, ns);
+}
+
+void LatencyHistogram::reset()
+{
+    const std::lock_guard lock(mutex);
+    clear();
+}
+
+LVLatencyStats LatencyHistogram::stats() const
+{
+    const std::lock_guard lock(mutex);
+    return computeStats();
+}
+
+LVLatencyStats LatencyHistogram::takeStats()
+{
+    const std::lock_guard lock(mutex);
+    auto current = computeStats();
+    clear();
+    return current;
+}
+
+void LatencyHistogram::clear()
+{
+    counts.fill(0);
+    total = 0;
+    sumNs = 0;
+    maxNs = 0;
+}
+
+LVLatencyStats LatencyHistogram::computeStats() const
+{
+    LVLatencyStats stats{total, 0.0, maxNs / 1000.0, 0.0, 0.0};
+    if (total == 0)
+    {
+        return stats;
+    }
+    stats.meanUs = static_cast<double>(sumNs) / total / 1000.0;
+
+    // smallest bucket bound with at least the given fraction of samples at or below it
+    auto percentile = [this](double fraction)
+    {
+        uint64_t rank = static_cast<uint64_t>(fraction * total + 0.5);
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < counts.size(); bucket++)
+        {
+            seen += counts[bucket];
+            if (seen >= rank)
+            {
+                return std::min(upperBoundOf(bucket), maxNs) / 1000.0;
+            }
+        }
+        return maxNs / 1000.0;
+    };
+    stats.p99Us = percentile(0.99);
+    stats.p999Us = percentile(0.999);
+    return stats;
+}
+
+ScopedLatency::ScopedLatency(LatencyHistogram &histogram) : histogram(histogram), start(std::chrono::steady_clock::now())
+{
+    // nothing else to construct
+}
+
+ScopedLatency::~ScopedLatency()
+{
+    histogram.record(std::chrono::steady_clock::now() - start);
+}
+
+// the cyclic GC is interpreter wide, so it stays off while any session is in real-time mode
+// the mutex guards this state and the sessions' realtimeMode, free-threaded builds have no GIL to serialize them
+static std::mutex realtimeMutex;
+static uint32_t realtimeSessions = 0;
+static bool gcWasEnabled = true;
+// duration of the last collection of each generation (negative until it has been timed), used to decide what fits in a budget
+static std::array<double, 3> lastCollectionMs = {-1.0, -1.0, -1.0};
+
+void setRealtimeMode(Session *session, bool enable)
+{
+    auto gc = pybind11::module_::import("gc");
+    const std::lock_guard lock(realtimeMutex);
+    if (enable && !session->realtimeMode)
+    {
+        if (realtimeSessions == 0)
+        {
+            gcWasEnabled = gc.attr("isenabled")().cast<bool>();
+            gc.attr("disable")();
+            // everything alive now (modules, the session's setup) is left out of later collections
+            gc.attr("freeze")();
+        }
+        realtimeSessions++;
+        session->realtimeMode = true;
+    }
+    else if (!enable && session->realtimeMode)
+    {
+        if (realtimeSessions == 1)
+        {
+            gc.attr("unfreeze")();
+            if (gcWasEnabled)
+            {
+                gc.attr("enable")();
+            }
+        }
+        realtimeSessions--;
+        session->realtimeMode = false;
+    }
+}
+
+int32_t set_realtime_mode(LVErrorClusterPtr errorPtr, SessionHandle session, LVBoolean enable, uint32_t reserveObjects)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        session->reserveObjects(reserveObjects);
+        setRealtimeMode(session, enable);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+// run the oldest GC generation whose last collection fitted in budgetMs, generation is -1 if none did
+// a generation which hasn't been timed yet only runs with an infinite budget, which also times the younger untimed ones
+int32_t gc_collect_budgeted(LVErrorClusterPtr errorPtr, SessionHandle session, double budgetMs, int32_t *generationPtr, int32_t *collectedPtr, double *elapsedMsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        bool unbounded = std::isinf(budgetMs) && budgetMs > 0.0;
+        std::array<double, 3> estimates;
+        {
+            const std::lock_guard lock(realtimeMutex);
+            estimates = lastCollectionMs;
+        }
+        int32_t generation = -1;
+        for (int32_t g = 0; g < 3; g++)
+        {
+            bool fits = estimates[g] >= 0.0 ? estimates[g] <= budgetMs : unbounded;
+            if (!fits)
+            {
+                break;
+            }
+            generation = g;
+        }
+
+        // the collections run without the mutex, finalizers may call back into gepit
+        auto collect = pybind11::module_::import("gc").attr("collect");
+        *collectedPtr = 0;
+        *elapsedMsPtr = 0.0;
+        for (int32_t g = 0; g <= generation; g++)
+        {
+            // younger generations are only collected on their own to time them
+            if (g < generation && estimates[g] >= 0.0)
+            {
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            *collectedPtr += collect(g).cast<int32_t>();
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            *elapsedMsPtr += elapsedMs;
+            const std::lock_guard lock(realtimeMutex);
+            lastCollectionMs[g] = elapsedMs;
+        }
+        *generationPtr = generation;
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t read_call_site_latency(LVErrorClusterPtr errorPtr, SessionHandle session, CallSiteHandle callSite, LVBoolean reset, LVLatencyStatsPtr statsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!callSite)
+    {
+        return writeInvalidCallSiteHandleErr(errorPtr, __func__);
+    }
+    // the histogram has its own lock, no GIL needed
+    *statsPtr = reset ? callSite->latency.takeStats() : callSite->latency.stats();
+    return 0;
+}
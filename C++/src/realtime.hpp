@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <mutex>
+
+#include <gepit/gepit.hpp>
+
+// fixed-size log-linear histogram of durations (about 6% resolution), recording never allocates
+// calls on the same call site can run in parallel in the free-threaded build, so the counts have a lock
+class LatencyHistogram
+{
+private:
+    mutable std::mutex mutex;
+    // 16 linear buckets per power of two
+    static constexpr size_t subBuckets = 16;
+    std::array<uint64_t, 64 * subBuckets> counts;
+    uint64_t total;
+    uint64_t sumNs;
+    uint64_t maxNs;
+
+    static size_t bucketOf(uint64_t ns);
+    static uint64_t upperBoundOf(size_t bucket);
+    // caller holds the mutex
+    void clear();
+    LVLatencyStats computeStats() const;
+
+public:
+    LatencyHistogram();
+    void record(std::chrono::nanoseconds duration);
+    void reset();
+    LVLatencyStats stats() const;
+    // the stats so far, resetting the histogram in the same step so no recording is lost in between
+    LVLatencyStats takeStats();
+};
+
+// records the time from construction to destruction into a histogram
+class ScopedLatency
+{
+private:
+    LatencyHistogram &histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedLatency(LatencyHistogram &histogram);
+    ~ScopedLatency();
+};
+
+// take a session into or out of real-time mode, the GC is turned back on when the last session leaves it
+// the GIL must be held
+void setRealtimeMode(Session *session, bool enable);
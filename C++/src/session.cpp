@@ -1,39 +1,261 @@
 #include <gepit/gepit.hpp>
 
-Session::Session() : scope(pybind11::module::import("__main__").attr("__dict__")), objStoreNextKey(1) // start at non-zero-value
+#include "buffer-pool.hpp"
+#include "event-loop.hpp"
+#include "iterator.hpp"
+#include "kernels.hpp"
+#include "profiler.hpp"
+#include "realtime.hpp"
+#include "summary.hpp"
+#include "watch.hpp"
+
+thread_local Session *activeSession = nullptr;
+
+Session::Session() : Session(pybind11::module::import("__main__").attr("__dict__"))
 {
     // nothing else to construct
 }
+Session::Session(pybind11::dict scope) : scope(scope),
+                                         pool(std::make_shared<BufferPool>(defaultMaxPooledBuffers, defaultMaxPooledBytes)),
+                                         watches(std::make_shared<WatchList>()),
+                                         kernels(std::make_shared<KernelRegistry>()),
+                                         prefetches(std::make_shared<IteratorPrefetches>()),
+                                         realtimeMode(false)
+{
+    // the gepit module registers the types (DLPackTensor, MappedArray...) that arguments and scope values are cast to
+    pybind11::module_::import("gepit");
+    registerLiveSession(this);
+}
+Session::~Session()
+{
+    unregisterLiveSession(this);
+}
+void Session::stopBackgroundThreads()
+{
+    std::shared_ptr<Profiler> stoppedProfiler;
+    std::shared_ptr<EventLoop> stoppedLoop;
+    {
+        const std::lock_guard lock(backgroundMutex);
+        stoppedProfiler = std::move(profiler);
+        stoppedLoop = std::move(eventLoop);
+    }
+    try
+    {
+        if (stoppedProfiler)
+        {
+            stoppedProfiler->stop();
+        }
+        if (stoppedLoop)
+        {
+            stoppedLoop->stop();
+        }
+        prefetches->join();
+    }
+    catch (...)
+    {
+        // handed back rather than released here without the GIL, the session keeps them until a retry succeeds
+        const std::lock_guard lock(backgroundMutex);
+        profiler = std::move(stoppedProfiler);
+        eventLoop = std::move(stoppedLoop);
+        throw;
+    }
+    if (stoppedLoop)
+    {
+        pybind11::gil_scoped_acquire gil;
+        stoppedLoop.reset();
+    }
+}
+Session::ObjectSlot *Session::findSlot(uint32_t key)
+{
+    uint32_t index = (key & ((1u << objStoreIndexBits) - 1)) - 1; // key 0 wraps to an invalid index
+    if (index >= objStore.size())
+    {
+        return nullptr;
+    }
+    auto &slot = objStore[index];
+    if (!slot.obj || slot.generation != key >> objStoreIndexBits)
+    {
+        return nullptr;
+    }
+    return &slot;
+}
 uint32_t Session::keepObject(pybind11::object obj)
 {
     const std::lock_guard lock(objStoreMutex);
-    objStore[objStoreNextKey] = obj;
-    return objStoreNextKey++;
+    uint32_t index;
+    if (!objStoreFreeSlots.empty())
+    {
+        index = objStoreFreeSlots.back();
+        objStoreFreeSlots.pop_back();
+    }
+    else
+    {
+        if (objStore.size() >= (1u << objStoreIndexBits) - 1)
+        {
+            throw std::length_error("The session object store is full, destroy Python objects which are no longer needed.");
+        }
+        index = static_cast<uint32_t>(objStore.size());
+        objStore.push_back({pybind11::object(), 0});
+    }
+    auto &slot = objStore[index];
+    slot.obj = std::move(obj);
+    // start at non-zero-value: the index part is offset by one
+    return (slot.generation << objStoreIndexBits) | (index + 1);
 }
 pybind11::object Session::getObject(uint32_t key)
 {
-    return objStore.at(key);
+    const std::shared_lock lock(objStoreMutex);
+    auto slot = findSlot(key);
+    if (!slot)
+    {
+        throw std::out_of_range("Null or Invalid Python Object reference.");
+    }
+    return slot->obj;
 }
 void Session::dropObject(uint32_t key)
 {
-    const std::lock_guard lock(objStoreMutex);
-    objStore.erase(key);
+    pybind11::object dropped;
+    {
+        const std::lock_guard lock(objStoreMutex);
+        auto slot = findSlot(key);
+        if (!slot)
+        {
+            return;
+        }
+        dropped = std::move(slot->obj);
+        slot->generation = (slot->generation + 1) & ((1u << (32 - objStoreIndexBits)) - 1);
+        objStoreFreeSlots.push_back(static_cast<uint32_t>(slot - objStore.data()));
+    }
+    // released outside the lock, a __del__ may store or drop other objects
 }
 bool Session::isNullObject(uint32_t key)
+{
+    const std::shared_lock lock(objStoreMutex);
+    return findSlot(key) == nullptr;
+}
+void Session::reserveObjects(uint32_t count)
 {
     const std::lock_guard lock(objStoreMutex);
-    return !(key > 0 && objStore.count(key));
+    objStore.reserve(objStore.size() + count);
+    objStoreFreeSlots.reserve(objStore.capacity());
+}
+std::vector<std::pair<uint32_t, pybind11::object>> Session::storedObjects()
+{
+    std::vector<std::pair<uint32_t, pybind11::object>> objects;
+    const std::shared_lock lock(objStoreMutex);
+    for (size_t index = 0; index < objStore.size(); index++)
+    {
+        const auto &slot = objStore[index];
+        if (slot.obj)
+        {
+            objects.emplace_back((slot.generation << objStoreIndexBits) | static_cast<uint32_t>(index + 1), slot.obj);
+        }
+    }
+    return objects;
+}
+void Session::restoreObjects(std::vector<std::pair<uint32_t, pybind11::object>> objects)
+{
+    const std::lock_guard lock(objStoreMutex);
+    // check every key first, so a failed restore leaves the store as it was
+    for (const auto &[key, obj] : objects)
+    {
+        uint32_t index = (key & ((1u << objStoreIndexBits) - 1)) - 1;
+        if (index >= (1u << objStoreIndexBits) - 1)
+        {
+            throw std::out_of_range("The checkpoint holds an invalid object reference (" + std::to_string(key) + ").");
+        }
+        if (index < objStore.size() && objStore[index].obj)
+        {
+            throw std::logic_error("Object reference " + std::to_string(key) + " can't be restored because its slot is in use, restore the objects into a new session.");
+        }
+    }
+    for (auto &[key, obj] : objects)
+    {
+        uint32_t index = (key & ((1u << objStoreIndexBits) - 1)) - 1;
+        while (objStore.size() <= index)
+        {
+            objStoreFreeSlots.push_back(static_cast<uint32_t>(objStore.size()));
+            objStore.push_back({pybind11::object(), 0});
+        }
+        std::erase(objStoreFreeSlots, index);
+        objStore[index] = {std::move(obj), key >> objStoreIndexBits};
+    }
+}
+pybind11::str Session::internName(std::string_view name)
+{
+    const std::lock_guard lock(internedNamesMutex);
+    auto cached = internedNames.find(name);
+    if (cached != internedNames.end())
+    {
+        return cached->second;
+    }
+    // names come from LabVIEW diagrams so there are few of them, but don't let a misuse grow the cache forever
+    if (internedNames.size() >= 4096)
+    {
+        internedNames.clear();
+    }
+    return internedNames.emplace(std::string(name), internedStr(name)).first->second;
+}
+PythonErrorRecord Session::readLastError()
+{
+    const std::lock_guard lock(lastErrorMutex);
+    return lastError;
+}
+void Session::writeLastError(PythonErrorRecord record)
+{
+    {
+        const std::lock_guard lock(lastErrorMutex);
+        std::swap(lastError, record);
+    }
+    // the previous record is released here, outside the lock
+}
+void Session::cacheFormattedTraceback(pybind11::handle value, std::string traceback)
+{
+    const std::lock_guard lock(lastErrorMutex);
+    if (lastError.value.is(value))
+    {
+        lastError.formattedTraceback = std::move(traceback);
+    }
+}
+uint32_t Session::keepLastErrorValue(pybind11::handle value)
+{
+    const std::lock_guard lock(lastErrorMutex);
+    bool current = lastError.value.is(value);
+    if (current && lastError.valueKey && !isNullObject(*lastError.valueKey))
+    {
+        return *lastError.valueKey;
+    }
+    auto key = keepObject(pybind11::reinterpret_borrow<pybind11::object>(value));
+    if (current)
+    {
+        lastError.valueKey = key;
+    }
+    return key;
+}
+Session *Session::active()
+{
+    return activeSession;
+}
+
+ActiveSessionGuard::ActiveSessionGuard(Session *session) : previous(activeSession)
+{
+    activeSession = session;
+}
+ActiveSessionGuard::~ActiveSessionGuard()
+{
+    activeSession = previous;
 }
 
 int32_t create_session(LVErrorClusterPtr errorPtr, SessionHandlePtr sessionPtr)
 {
+    pybind11::gil_scoped_acquire gil;
     try
     {
         *sessionPtr = new Session();
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, nullptr, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -54,11 +276,133 @@ int32_t destroy_session(LVErrorClusterPtr errorPtr, SessionHandle session)
     }
     try
     {
+        // the profiler's sampler thread, the event loop thread and iterator prefetches have to be joined before taking the GIL
+        session->stopBackgroundThreads();
+        pybind11::gil_scoped_acquire gil;
+        // the GC stays off while any session is in real-time mode, this one no longer counts
+        setRealtimeMode(session, false);
         delete session;
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        pybind11::gil_scoped_acquire gil;
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+// values a cloned scope can always share with its source
+static bool is_shareable(pybind11::handle value, pybind11::handle ndarrayType)
+{
+    if (PyModule_Check(value.ptr()) || PyType_Check(value.ptr()) || PyCallable_Check(value.ptr()))
+    {
+        return true;
+    }
+    if (value.is_none() || PyBool_Check(value.ptr()) || PyLong_Check(value.ptr()) || PyFloat_Check(value.ptr()) || PyComplex_Check(value.ptr()) ||
+        PyUnicode_Check(value.ptr()) || PyBytes_Check(value.ptr()) || PyTuple_Check(value.ptr()) || PyFrozenSet_Check(value.ptr()))
+    {
+        return true;
+    }
+    // read-only arrays (lookup tables, model weights) are shared rather than copied
+    if (ndarrayType && pybind11::isinstance(value, ndarrayType))
+    {
+        return !value.attr("flags").attr("writeable").cast<bool>();
+    }
+    return false;
+}
+
+// a function whose globals are the source scope, re-bound to the cloned scope
+static pybind11::object rebind_function(pybind11::handle fn, pybind11::dict scope)
+{
+    auto functionType = pybind11::module_::import("types").attr("FunctionType");
+    auto rebound = functionType(fn.attr("__code__"), scope, fn.attr("__name__"), fn.attr("__defaults__"), fn.attr("__closure__"));
+    rebound.attr("__kwdefaults__") = fn.attr("__kwdefaults__");
+    rebound.attr("__qualname__") = fn.attr("__qualname__");
+    rebound.attr("__doc__") = fn.attr("__doc__");
+    rebound.attr("__dict__").attr("update")(fn.attr("__dict__"));
+    return rebound;
+}
+
+// shallow copy of a session scope
+// names can be re-bound independently while the objects themselves are shared
+// functions defined in the source scope are re-bound so their globals are the clone's scope
+// (methods of classes defined there still see the source scope)
+// with copyMutable, other mutable values are deep-copied with read-only arrays and shared values preserved
+static pybind11::dict clone_scope(pybind11::dict source, bool copyMutable)
+{
+    PyObject *copied = PyDict_Copy(source.ptr());
+    if (!copied)
+    {
+        throw pybind11::error_already_set();
+    }
+    auto scope = pybind11::reinterpret_steal<pybind11::dict>(copied);
+    auto functionType = pybind11::module_::import("types").attr("FunctionType");
+
+    pybind11::object ndarrayType;
+    pybind11::object deepcopy;
+    pybind11::dict memo;
+    if (copyMutable)
+    {
+        try
+        {
+            ndarrayType = pybind11::module_::import("numpy").attr("ndarray");
+        }
+        catch (pybind11::error_already_set const &)
+        {
+            // no numpy, no arrays to share
+        }
+        deepcopy = pybind11::module_::import("copy").attr("deepcopy");
+        // seed the memo so deep copies keep referring to the shared objects
+        for (auto item : source)
+        {
+            if (is_shareable(item.second, ndarrayType))
+            {
+                memo[pybind11::int_(reinterpret_cast<uintptr_t>(item.second.ptr()))] = item.second;
+            }
+        }
+    }
+
+    for (auto item : source)
+    {
+        auto value = item.second;
+        if (pybind11::isinstance(value, functionType))
+        {
+            if (value.attr("__globals__").is(source))
+            {
+                scope[item.first] = rebind_function(value, scope);
+            }
+            continue;
+        }
+        if (copyMutable && !is_shareable(value, ndarrayType))
+        {
+            scope[item.first] = deepcopy(value, memo);
+        }
+    }
+    return scope;
+}
+
+int32_t clone_session(LVErrorClusterPtr errorPtr, SessionHandle session, LVBoolean copyMutableValues, SessionHandlePtr clonePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        *clonePtr = new Session(clone_scope(session->scope, copyMutableValues));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -77,6 +421,7 @@ int32_t read_session_attribute_as_string(LVErrorClusterPtr errorPtr, SessionHand
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
     try
     {
         std::string attrName = lvStrHandleToStdString(attributeNameStrHandle);
@@ -84,13 +429,13 @@ int32_t read_session_attribute_as_string(LVErrorClusterPtr errorPtr, SessionHand
         {
             *found = LVBooleanTrue;
             auto value = session->scope[attrName.c_str()];
-            return writeStringToStringHandlePtr(valueStrHandlePtr, pybind11::str(value));
+            return writeStringToStringHandlePtr(valueStrHandlePtr, pybind11::str(value).cast<std::string>());
         }
         *found = LVBooleanFalse;
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -109,13 +454,61 @@ int32_t scope_as_str(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHan
     {
         return writeInvalidSessionHandleErr(errorPtr, __func__);
     }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        writeStringToStringHandlePtr(handle, pybind11::str(session->scope).cast<std::string>());
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t scope_summary(LVErrorClusterPtr errorPtr, SessionHandle session, int32_t maxLength, LVStrHandlePtr handle)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
     try
     {
-        writeStringToStringHandlePtr(handle, pybind11::str(session->scope));
+        // "name: type shape dtype" per variable, without stringifying any of the values
+        std::string summary;
+        size_t remaining = session->scope.size();
+        auto moreLine = [](size_t count) { return "... (" + std::to_string(count) + " more)\n"; };
+        for (auto item : session->scope)
+        {
+            std::string line = pybind11::str(item.first).cast<std::string>() + ": " + typeSummary(item.second) + "\n";
+            // a line only goes in if the "more" line for the variables after it still fits as well
+            size_t needed = summary.length() + line.length() + (remaining > 1 ? moreLine(remaining - 1).length() : 0);
+            if (maxLength >= 0 && needed > static_cast<size_t>(maxLength))
+            {
+                auto more = moreLine(remaining);
+                if (summary.length() + more.length() <= static_cast<size_t>(maxLength))
+                {
+                    summary += more;
+                }
+                break;
+            }
+            summary += line;
+            remaining--;
+        }
+        return writeStringToStringHandlePtr(handle, summary);
     }
     catch (pybind11::error_already_set const &e)
     {
-        return writePythonExceptionErr(errorPtr, __func__, e.what());
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
     }
     catch (std::exception const &e)
     {
@@ -126,4 +519,51 @@ int32_t scope_as_str(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrHan
         return writeUnkownErr(errorPtr, __func__);
     }
     return 0;
-}
\ No newline at end of file
+}
+
+int32_t scope_keys(LVErrorClusterPtr errorPtr, SessionHandle session, int64_t *cursorPtr, int32_t maxKeys, LVStrHandlePtr keysStrHandlePtr, LVBoolean *donePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        // the cursor is the PyDict_Next position: start from 0 and pass the returned value back for the next page
+        // (keys may be skipped or repeated if variables are added or removed between pages)
+        Py_ssize_t position = static_cast<Py_ssize_t>(*cursorPtr);
+        PyObject *key = nullptr;
+        PyObject *value = nullptr;
+        std::string keys;
+        int32_t count = 0;
+        bool more = true;
+        while (count < maxKeys && (more = PyDict_Next(session->scope.ptr(), &position, &key, &value)))
+        {
+            keys += pybind11::str(key).cast<std::string>() + "\n";
+            count++;
+        }
+        // peek so the last page reports done
+        if (more)
+        {
+            Py_ssize_t peek = position;
+            more = PyDict_Next(session->scope.ptr(), &peek, &key, &value);
+        }
+        *cursorPtr = position;
+        *donePtr = more ? LVBooleanFalse : LVBooleanTrue;
+        return writeStringToStringHandlePtr(keysStrHandlePtr, keys);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
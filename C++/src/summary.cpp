@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "summary.hpp"
+
+// marker appended to truncated text
+constexpr std::string_view ellipsis = "...";
+
+static void truncate(std::string &text, size_t maxLength)
+{
+    if (text.length() > maxLength)
+    {
+        size_t keep = maxLength > ellipsis.length() ? maxLength - ellipsis.length() : 0;
+        // back up to the start of a UTF-8 sequence (continuation bytes are 10xxxxxx)
+        while (keep > 0 && (static_cast<unsigned char>(text[keep]) & 0xC0) == 0x80)
+        {
+            keep--;
+        }
+        text.resize(keep);
+        // a limit shorter than the marker only gets as much of it as fits
+        text += ellipsis.substr(0, std::min(maxLength, ellipsis.length()));
+    }
+}
+
+static bool is_ndarray(pybind11::handle obj)
+{
+    return pybind11::isinstance<pybind11::array>(obj);
+}
+
+std::string boundedRepr(pybind11::handle obj, size_t maxLength, size_t maxItems)
+{
+    std::string text;
+    if (is_ndarray(obj))
+    {
+        // arrays with more than threshold elements only print edgeitems from each end of each axis
+        size_t edgeItems = std::max<size_t>(1, std::min<size_t>(3, maxItems / 2));
+        text = typeSummary(obj) + "\n";
+        text += pybind11::module_::import("numpy").attr("array2string")(obj, pybind11::arg("threshold") = maxItems, pybind11::arg("edgeitems") = edgeItems, pybind11::arg("max_line_width") = 120).cast<std::string>();
+    }
+    else
+    {
+        // reprlib limits containers, nesting depth and long strings while the repr is built
+        auto repr = pybind11::module_::import("reprlib").attr("Repr")();
+        for (auto limit : {"maxlist", "maxtuple", "maxdict", "maxset", "maxfrozenset", "maxdeque", "maxarray"})
+        {
+            repr.attr(limit) = maxItems;
+        }
+        repr.attr("maxlevel") = 3;
+        repr.attr("maxstring") = maxLength;
+        repr.attr("maxlong") = maxLength;
+        repr.attr("maxother") = maxLength;
+        text = repr.attr("repr")(obj).cast<std::string>();
+    }
+    truncate(text, maxLength);
+    return text;
+}
+
+std::string typeSummary(pybind11::handle obj)
+{
+    std::string summary = pybind11::type::handle_of(obj).attr("__qualname__").cast<std::string>();
+    if (is_ndarray(obj))
+    {
+        auto array = pybind11::reinterpret_borrow<pybind11::array>(obj);
+        summary += " shape=(";
+        for (pybind11::ssize_t i = 0; i < array.ndim(); i++)
+        {
+            summary += (i ? ", " : "") + std::to_string(array.shape(i));
+        }
+        summary += ") dtype=" + pybind11::str(array.dtype()).cast<std::string>();
+    }
+    else if (PyModule_Check(obj.ptr()))
+    {
+        summary += " " + pybind11::str(obj.attr("__name__")).cast<std::string>();
+    }
+    else if (!PyType_Check(obj.ptr()) && PyObject_HasAttrString(obj.ptr(), "__len__"))
+    {
+        Py_ssize_t length = PyObject_Length(obj.ptr());
+        if (length >= 0)
+        {
+            summary += " len=" + std::to_string(length);
+        }
+        else
+        {
+            PyErr_Clear();
+        }
+    }
+    return summary;
+}
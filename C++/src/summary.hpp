@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+#include <gepit/gepit.hpp>
+
+// repr of obj limited to about maxLength characters and maxItems elements per container
+// numpy arrays are summarised (first/last items) rather than printed in full
+std::string boundedRepr(pybind11::handle obj, size_t maxLength, size_t maxItems);
+
+// one line description "type [shape=(..) dtype=..|len=..]" which never stringifies the value itself
+std::string typeSummary(pybind11::handle obj);
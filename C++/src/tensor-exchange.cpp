@@ -0,0 +1,151 @@
+#include <vector>
+
+#include "tensor-exchange.hpp"
+
+// DLPack producer for a numpy view of a LabVIEW array (gepit.DLPackTensor)
+struct DLPackTensor
+{
+    pybind11::array view;
+};
+
+// owns everything a DLManagedTensor points at until the consumer calls its deleter
+struct DLPackExport
+{
+    DLManagedTensor managed;
+    std::vector<int64_t> shape;
+    std::vector<int64_t> strides;
+    pybind11::object owner;
+};
+
+static void deleteDLPackExport(DLManagedTensor *self)
+{
+    // consumers may call the deleter from any thread
+    pybind11::gil_scoped_acquire gil;
+    delete static_cast<DLPackExport *>(self->manager_ctx);
+}
+
+static void deleteUnconsumedDLPackCapsule(PyObject *capsule)
+{
+    // consumers rename the capsule to "used_dltensor" and take over the deleter
+    if (PyCapsule_IsValid(capsule, "dltensor"))
+    {
+        auto managed = static_cast<DLManagedTensor *>(PyCapsule_GetPointer(capsule, "dltensor"));
+        managed->deleter(managed);
+    }
+}
+
+static DLDataType dlpackDataType(pybind11::dtype dtype)
+{
+    DLDataType dlType{0, static_cast<uint8_t>(dtype.itemsize() * 8), 1};
+    switch (dtype.kind())
+    {
+    case 'i':
+        dlType.code = kDLInt;
+        break;
+    case 'u':
+        dlType.code = kDLUInt;
+        break;
+    case 'f':
+        if (dtype.itemsize() > 8)
+        {
+            throw std::invalid_argument("Extended precision arrays can't be exchanged through DLPack.");
+        }
+        dlType.code = kDLFloat;
+        break;
+    default:
+        throw std::invalid_argument("The array's dtype can't be exchanged through DLPack.");
+    }
+    return dlType;
+}
+
+static pybind11::capsule dlpackCapsule(pybind11::array view)
+{
+    auto exported = std::make_unique<DLPackExport>();
+    auto ndim = view.ndim();
+    auto itemsize = view.itemsize();
+    for (pybind11::ssize_t i = 0; i < ndim; i++)
+    {
+        exported->shape.push_back(view.shape(i));
+        exported->strides.push_back(view.strides(i) / itemsize);
+    }
+    exported->owner = view;
+
+    DLTensor &tensor = exported->managed.dl_tensor;
+    tensor.data = const_cast<void *>(view.data());
+    tensor.device = {kDLCPU, 0};
+    tensor.ndim = static_cast<int32_t>(ndim);
+    tensor.dtype = dlpackDataType(view.dtype());
+    tensor.shape = exported->shape.data();
+    tensor.strides = exported->strides.data();
+    tensor.byte_offset = 0;
+    exported->managed.manager_ctx = exported.get();
+    exported->managed.deleter = &deleteDLPackExport;
+
+    PyObject *capsule = PyCapsule_New(&exported->managed, "dltensor", &deleteUnconsumedDLPackCapsule);
+    if (!capsule)
+    {
+        throw pybind11::error_already_set();
+    }
+    exported.release();
+    return pybind11::reinterpret_steal<pybind11::capsule>(capsule);
+}
+
+pybind11::object toDLPackProducer(pybind11::array view)
+{
+    // fail now rather than in the consumer
+    dlpackDataType(view.dtype());
+    return pybind11::cast(DLPackTensor{view});
+}
+
+pybind11::object toArrowArray(pybind11::array view)
+{
+    auto pyarrow = pybind11::module_::import("pyarrow");
+    if (view.ndim() != 1)
+    {
+        return pyarrow.attr("Tensor").attr("from_numpy")(view);
+    }
+    if (view.strides(0) != view.itemsize())
+    {
+        throw std::invalid_argument("Only contiguous array regions can be passed as Arrow arrays.");
+    }
+    // foreign_buffer wraps the LabVIEW memory, keeping the view alive as its base
+    auto buffer = pyarrow.attr("foreign_buffer")(reinterpret_cast<uintptr_t>(view.data()), view.nbytes(), view);
+    auto type = pyarrow.attr("from_numpy_dtype")(view.dtype());
+    pybind11::list buffers;
+    buffers.append(pybind11::none());
+    buffers.append(buffer);
+    return pyarrow.attr("Array").attr("from_buffers")(type, view.shape(0), buffers);
+}
+
+pybind11::object asArrayLike(pybind11::handle obj)
+{
+    if (pybind11::isinstance<pybind11::array>(obj))
+    {
+        return pybind11::reinterpret_borrow<pybind11::object>(obj);
+    }
+    if (pybind11::hasattr(obj, "__dlpack__"))
+    {
+        return pybind11::module_::import("numpy").attr("from_dlpack")(obj);
+    }
+    if (!pybind11::hasattr(obj, "__array__") && pybind11::hasattr(obj, "to_numpy"))
+    {
+        return obj.attr("to_numpy")();
+    }
+    return pybind11::reinterpret_borrow<pybind11::object>(obj);
+}
+
+// python side: the gepit.DLPackTensor objects passed for DLPACK_MODE arguments
+void bind_tensor_exchange(pybind11::module_ &m)
+{
+    pybind11::class_<DLPackTensor>(m, "DLPackTensor", "Zero-copy DLPack producer for a LabVIEW array argument, only valid during the call")
+        .def("__dlpack__", [](const DLPackTensor &self, pybind11::object stream, pybind11::kwargs)
+             { return dlpackCapsule(self.view); }, pybind11::arg("stream") = pybind11::none())
+        .def("__dlpack_device__", [](const DLPackTensor &)
+             { return pybind11::make_tuple(static_cast<int32_t>(kDLCPU), 0); })
+        .def_property_readonly("address", [](const DLPackTensor &self)
+             { return reinterpret_cast<uintptr_t>(self.view.data()); }, "Address of the LabVIEW array data (to check consumers didn't copy it)")
+        .def_property_readonly("shape", [](const DLPackTensor &self)
+             { return self.view.attr("shape"); })
+        .def_property_readonly("dtype", [](const DLPackTensor &self)
+             { return self.view.dtype(); });
+}
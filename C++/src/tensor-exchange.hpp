@@ -0,0 +1,58 @@
+#pragma once
+
+#include <gepit/gepit.hpp>
+
+// DLPack ABI (https://dmlc.github.io/dlpack/latest/c_api.html), declared here rather than vendoring dlpack.h
+enum DLDeviceType : int32_t
+{
+    kDLCPU = 1
+};
+
+enum DLDataTypeCode : uint8_t
+{
+    kDLInt = 0,
+    kDLUInt = 1,
+    kDLFloat = 2
+};
+
+struct DLDevice
+{
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType
+{
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor
+{
+    void *data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t *shape;
+    int64_t *strides; // in elements
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor
+{
+    DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter)(DLManagedTensor *self);
+};
+
+// wrap a numpy view of a LabVIEW array without copying it
+// like the view, the result must not be used after the DLL call that created it returns
+pybind11::object toDLPackProducer(pybind11::array view);
+pybind11::object toArrowArray(pybind11::array view);
+
+// obj as something numpy can convert: DLPack producers (torch, jax, cupy on cpu...) are imported
+// through numpy.from_dlpack, objects with only a to_numpy() (pyarrow.Tensor...) are converted by it
+pybind11::object asArrayLike(pybind11::handle obj);
+
+void bind_tensor_exchange(pybind11::module_ &m);
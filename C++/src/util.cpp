@@ -1,27 +1,157 @@
+#include <algorithm>
+#include <limits>
+#include <span>
+
 #include <gepit/gepit.hpp>
 
 // error output implementations
-MgErr writeInvalidSessionHandleErr(LVErrorClusterPtr errorPtr, std::string functionName)
+// function names are passed straight from __func__ so nothing is allocated until an error is written
+MgErr writeInvalidSessionHandleErr(LVErrorClusterPtr errorPtr, const char *functionName)
 {
     return writeErrorToErrorClusterPtr(errorPtr, errorCodes::InvalidSessionHandle, functionName, "The session-handle supplied is invalid.");
 }
 
-MgErr writeInvalidPythonObjectRefErr(LVErrorClusterPtr errorPtr, std::string functionName)
+MgErr writeInvalidCallSiteHandleErr(LVErrorClusterPtr errorPtr, const char *functionName)
+{
+    return writeErrorToErrorClusterPtr(errorPtr, errorCodes::InvalidCallSiteHandle, functionName, "The call-site-handle supplied is invalid.");
+}
+
+MgErr writeInvalidPipelineHandleErr(LVErrorClusterPtr errorPtr, const char *functionName)
+{
+    return writeErrorToErrorClusterPtr(errorPtr, errorCodes::InvalidPipelineHandle, functionName, "The pipeline-handle supplied is invalid.");
+}
+
+MgErr writeInvalidMappedArrayHandleErr(LVErrorClusterPtr errorPtr, const char *functionName)
+{
+    return writeErrorToErrorClusterPtr(errorPtr, errorCodes::InvalidMappedArrayHandle, functionName, "The mapped-array-handle supplied is invalid.");
+}
+
+MgErr writeInvalidWorkerPoolHandleErr(LVErrorClusterPtr errorPtr, const char *functionName)
+{
+    return writeErrorToErrorClusterPtr(errorPtr, errorCodes::InvalidWorkerPoolHandle, functionName, "The worker-pool-handle supplied is invalid.");
+}
+
+MgErr writeInvalidPythonObjectRefErr(LVErrorClusterPtr errorPtr, const char *functionName)
 {
     return writeErrorToErrorClusterPtr(errorPtr, errorCodes::PythonObjectInvalid, functionName, "The Python Object Reference is invalid.");
 }
 
-MgErr writePythonExceptionErr(LVErrorClusterPtr errorPtr, std::string functionName, std::string what)
+MgErr writePythonExceptionErr(LVErrorClusterPtr errorPtr, Session *session, const char *functionName, pybind11::error_already_set const &e)
 {
-    return writeErrorToErrorClusterPtr(errorPtr, errorCodes::PythonExceptionErr, functionName, what);
+    // only "ExceptionType: message" goes into the error cluster, formatting the traceback is
+    // left to read_python_error so that frequently raised (and handled) exceptions stay cheap
+    std::string message;
+    try
+    {
+        message = e.type().attr("__name__").cast<std::string>();
+        auto value = pybind11::str(e.value()).cast<std::string>();
+        if (!value.empty())
+        {
+            message += ": " + value;
+        }
+    }
+    catch (...)
+    {
+        message = e.what();
+    }
+
+    if (session)
+    {
+        session->writeLastError(PythonErrorRecord{e.type(), e.value(), e.trace()});
+    }
+    return writeErrorToErrorClusterPtr(errorPtr, errorCodes::PythonExceptionErr, functionName, message);
 }
 
-MgErr writeStdExceptionErr(LVErrorClusterPtr errorPtr, std::string functionName, std::string what)
+MgErr writeStdExceptionErr(LVErrorClusterPtr errorPtr, const char *functionName, const char *what)
 {
     return writeErrorToErrorClusterPtr(errorPtr, errorCodes::StdExceptionErr, functionName, what);
 }
 
-MgErr writeUnkownErr(LVErrorClusterPtr errorPtr, std::string functionName)
+MgErr writeUnkownErr(LVErrorClusterPtr errorPtr, const char *functionName)
 {
     return writeErrorToErrorClusterPtr(errorPtr, errorCodes::UnknownErr, functionName, "");
-}
\ No newline at end of file
+}
+
+MgErr writeInterpreterConfigIgnoredWarn(LVErrorClusterPtr errorPtr, const char *functionName)
+{
+    MgErr err = writeErrorToErrorClusterPtr(errorPtr, errorCodes::InterpreterConfigIgnored, functionName, "The interpreter is already running, the configuration passed was not applied.");
+    errorPtr->status = LVBooleanFalse;
+    return err;
+}
+
+pybind11::str internedStr(std::string_view s)
+{
+    PyObject *str = PyUnicode_FromStringAndSize(s.data(), s.length());
+    if (!str)
+    {
+        throw pybind11::error_already_set();
+    }
+    PyUnicode_InternInPlace(&str);
+    return pybind11::reinterpret_steal<pybind11::str>(str);
+}
+
+std::string_view lvStrHandleToStringView(LVStrHandle handle)
+{
+    if (!handle || !(*handle))
+    {
+        return std::string_view();
+    }
+    return std::string_view(reinterpret_cast<const char *>((*handle)->str), (*handle)->cnt);
+}
+
+pybind11::str lvStrHandleToPyStr(LVStrHandle handle)
+{
+    if (!handle || !(*handle))
+    {
+        return pybind11::str("");
+    }
+    return pybind11::str(reinterpret_cast<const char *>((*handle)->str), (*handle)->cnt);
+}
+
+std::vector<std::string> lvStrArrayHandleToStdStrings(LVStrArrayHandle handle)
+{
+    std::vector<std::string> strings;
+    if (!handle || !(*handle))
+    {
+        return strings;
+    }
+    size_t count = (*handle)->dims[0];
+    strings.reserve(count);
+    for (const auto &strHandle : std::span((*handle)->data(), count))
+    {
+        strings.push_back(lvStrHandleToStdString(strHandle));
+    }
+    return strings;
+}
+
+MgErr writeDoublesToDblArrayHandlePtr(LVDblArrayHandle *handlePtr, std::span<const double> values)
+{
+    if (values.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+    {
+        return LV_MFULL_ERR;
+    }
+    auto result = LVNumericArrayResize(LV_DOUBLE_TYPECODE, 1, handlePtr, values.size());
+    if (result != 0)
+    {
+        return result;
+    }
+    (**handlePtr)->dims[0] = static_cast<int32_t>(values.size());
+    std::copy(values.begin(), values.end(), (**handlePtr)->data());
+    return 0;
+}
+
+MgErr writeBooleansToBooleanArrayHandlePtr(LVBooleanArrayHandle *handlePtr, std::span<const LVBoolean> values)
+{
+    if (values.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+    {
+        return LV_MFULL_ERR;
+    }
+    auto result = LVNumericArrayResize(LV_U8_TYPECODE, 1, handlePtr, values.size());
+    if (result != 0)
+    {
+        return result;
+    }
+    (**handlePtr)->dims[0] = static_cast<int32_t>(values.size());
+    std::copy(values.begin(), values.end(), (**handlePtr)->data());
+    return 0;
+}
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "attributes.hpp"
+#include "watch.hpp"
+
+static std::mutex liveSessionsMutex;
+static std::set<Session *> liveSessions;
+
+void registerLiveSession(Session *session)
+{
+    const std::lock_guard lock(liveSessionsMutex);
+    liveSessions.insert(session);
+}
+
+void unregisterLiveSession(Session *session)
+{
+    const std::lock_guard lock(liveSessionsMutex);
+    liveSessions.erase(session);
+}
+
+std::vector<Session *> snapshotLiveSessions()
+{
+    const std::lock_guard lock(liveSessionsMutex);
+    return {liveSessions.begin(), liveSessions.end()};
+}
+
+WatchList::WatchList() : userEvent(0), hasUserEvent(false), changeCount(0)
+{
+    // nothing else to construct
+}
+
+void WatchList::watch(const std::vector<std::string> &names)
+{
+    const std::lock_guard lock(mutex);
+    for (const auto &name : names)
+    {
+        // a new watch starts out changed so the first read delivers the current value
+        watched.insert_or_assign(name, true);
+    }
+}
+
+void WatchList::unwatch(const std::vector<std::string> &names)
+{
+    const std::lock_guard lock(mutex);
+    for (const auto &name : names)
+    {
+        watched.erase(name);
+    }
+}
+
+void WatchList::setUserEvent(LVUserEventRef *eventRefPtr)
+{
+    const std::lock_guard lock(mutex);
+    hasUserEvent = eventRefPtr && *eventRefPtr;
+    userEvent = hasUserEvent ? *eventRefPtr : 0;
+}
+
+void WatchList::notify(const std::vector<std::string> &names)
+{
+    int32_t newlyChanged = 0;
+    LVUserEventRef event;
+    bool post;
+    {
+        const std::lock_guard lock(mutex);
+        for (const auto &name : names)
+        {
+            auto entry = watched.find(name);
+            if (entry != watched.end() && !entry->second)
+            {
+                entry->second = true;
+                newlyChanged++;
+            }
+        }
+        event = userEvent;
+        post = hasUserEvent;
+    }
+    if (newlyChanged == 0)
+    {
+        return;
+    }
+    changeCount.fetch_add(newlyChanged, std::memory_order_release);
+    // repeated notifies of an unread name don't post again, so a fast producer can't flood the event queue
+    if (post)
+    {
+        LVPostUserEvent(event, &newlyChanged);
+    }
+}
+
+std::vector<LVBoolean> WatchList::takeChanged(const std::vector<std::string> &names)
+{
+    const std::lock_guard lock(mutex);
+    std::vector<LVBoolean> changed(names.size(), LVBooleanFalse);
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        auto entry = watched.find(names[i]);
+        if (entry != watched.end() && entry->second)
+        {
+            entry->second = false;
+            changed[i] = LVBooleanTrue;
+        }
+    }
+    return changed;
+}
+
+void WatchList::restoreChanged(const std::vector<std::string> &names, const std::vector<LVBoolean> &changed)
+{
+    const std::lock_guard lock(mutex);
+    for (size_t i = 0; i < names.size() && i < changed.size(); i++)
+    {
+        auto entry = watched.find(names[i]);
+        if (changed[i] && entry != watched.end())
+        {
+            entry->second = true;
+        }
+    }
+}
+
+// call fn for the active session, or else every live session whose scope is the calling code's globals, returns how many there were
+// the live sessions stay locked meanwhile, so a destroy_session on another thread can't free one of them under fn
+template <typename Fn>
+static size_t forEachNotifyTarget(Fn fn)
+{
+    if (Session *session = Session::active())
+    {
+        fn(session);
+        return 1;
+    }
+    PyObject *globals = PyEval_GetGlobals();
+    size_t count = 0;
+    const std::lock_guard lock(liveSessionsMutex);
+    for (Session *session : liveSessions)
+    {
+        if (session->scope.ptr() == globals)
+        {
+            fn(session);
+            count++;
+        }
+    }
+    return count;
+}
+
+static void notify(pybind11::args names)
+{
+    std::vector<std::string> changed;
+    changed.reserve(names.size());
+    for (auto name : names)
+    {
+        changed.push_back(name.cast<std::string>());
+    }
+    forEachNotifyTarget([&changed](Session *session) { session->watches->notify(changed); });
+}
+
+static void publish(pybind11::str name, pybind11::object value)
+{
+    std::vector<std::string> changed{name.cast<std::string>()};
+    // declared before the lock is taken, the values replaced are released after it (their __del__ may publish too)
+    std::vector<pybind11::object> replaced;
+    auto count = forEachNotifyTarget([&](Session *session)
+    {
+        if (session->scope.contains(name))
+        {
+            replaced.push_back(session->scope[name]);
+        }
+        session->scope[name] = value;
+        session->watches->notify(changed);
+    });
+    if (count == 0)
+    {
+        throw std::runtime_error("gepit.publish() can only be used from code running in a gepit session scope");
+    }
+}
+
+// python side: gepit.notify(*names) and gepit.publish(name, value)
+void bind_watch(pybind11::module_ &m)
+{
+    m.def("notify", &notify, "Mark session scope variables as changed for LabVIEW code watching them");
+    m.def("publish", &publish, pybind11::arg("name"), pybind11::arg("value"),
+          "Set a session scope variable and mark it as changed");
+}
+
+int32_t watch_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        session->watches->watch(lvStrArrayHandleToStdStrings(namesHandle));
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t unwatch_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        session->watches->unwatch(lvStrArrayHandleToStdStrings(namesHandle));
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t set_watch_user_event(LVErrorClusterPtr errorPtr, SessionHandle session, LVUserEventRef *eventRefPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    try
+    {
+        session->watches->setUserEvent(eventRefPtr);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t read_watch_change_count(LVErrorClusterPtr errorPtr, SessionHandle session, uint64_t *changeCountPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    *changeCountPtr = session->watches->changeCount.load(std::memory_order_acquire);
+    return 0;
+}
+
+int32_t read_changed_session_attributes(LVErrorClusterPtr errorPtr, SessionHandle session, LVStrArrayHandle namesHandle, LVArgumentTypeInfoHandle typesInfoHandle, LVArgumentClusterPtr valuesPtr, LVDblArrayHandle *scalarsHandlePtr, LVBooleanArrayHandle *changedHandlePtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto names = internAttributeNames(session, namesHandle);
+        auto types = attributeTypes(typesInfoHandle, names.size());
+
+        // flags are taken with the GIL held so a notify can't slip in between the read and the clear
+        auto watchNames = lvStrArrayHandleToStdStrings(namesHandle);
+        auto changed = session->watches->takeChanged(watchNames);
+        try
+        {
+            std::vector<double> scalars;
+            std::vector<LVBoolean> found;
+            readAttributeValues(session, names, types, valuesPtr, scalars, found, &changed);
+
+            MgErr err = writeDoublesToDblArrayHandlePtr(scalarsHandlePtr, scalars);
+            if (err == 0)
+            {
+                err = writeBooleansToBooleanArrayHandlePtr(changedHandlePtr, found);
+            }
+            if (err != 0)
+            {
+                throw std::runtime_error("LabVIEW could not resize the output arrays (error " + std::to_string(err) + ").");
+            }
+        }
+        catch (...)
+        {
+            // the values never reached LabVIEW, the next read has to pick them up again
+            session->watches->restoreChanged(watchNames, changed);
+            throw;
+        }
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gepit/gepit.hpp>
+
+// scope variables LabVIEW has subscribed to and which of them Python has marked as changed
+// python marks names with gepit.notify() / gepit.publish(), LabVIEW reads only the changed ones
+class WatchList
+{
+private:
+    std::mutex mutex;
+    // watched name -> changed since LabVIEW last read it
+    std::map<std::string, bool, std::less<>> watched;
+    LVUserEventRef userEvent;
+    bool hasUserEvent;
+
+public:
+    // bumped on every change to a watched name, can be polled without the GIL
+    std::atomic<uint64_t> changeCount;
+
+    WatchList();
+    void watch(const std::vector<std::string> &names);
+    void unwatch(const std::vector<std::string> &names);
+    void setUserEvent(LVUserEventRef *eventRefPtr);
+    // mark names as changed, names that are not watched are ignored
+    void notify(const std::vector<std::string> &names);
+    // clear the changed flags of names, returning which of them were set
+    std::vector<LVBoolean> takeChanged(const std::vector<std::string> &names);
+    // set the flags takeChanged returned again, when the values could not be delivered
+    void restoreChanged(const std::vector<std::string> &names, const std::vector<LVBoolean> &changed);
+};
+
+// sessions that are alive, so Python code running outside a DLL call can find the sessions it belongs to
+void registerLiveSession(Session *session);
+void unregisterLiveSession(Session *session);
+std::vector<Session *> snapshotLiveSessions();
+
+void bind_watch(pybind11::module_ &m);
@@ -0,0 +1,180 @@
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <span>
+
+#include "buffer-pool.hpp"
+#include "lv-array.hpp"
+#include "tensor-exchange.hpp"
+#include "waveform.hpp"
+
+// seconds from the LabVIEW epoch (1904) to the Unix epoch (1970), numpy datetime64 counts from the latter
+constexpr int64_t lvEpochOffset = 2082844800;
+constexpr int64_t nsPerSecond = 1000000000;
+
+static int64_t timestampToNs(const LVTimestamp &t)
+{
+    // LabVIEW only resolves about 1/2^32 s anyway, a double keeps the fraction to well under a ns
+    auto fractionNs = static_cast<int64_t>(std::llround(std::ldexp(static_cast<double>(t.fraction), -64) * 1e9));
+    return (t.seconds - lvEpochOffset) * nsPerSecond + fractionNs;
+}
+
+static LVTimestamp nsToTimestamp(int64_t ns)
+{
+    int64_t seconds = ns / nsPerSecond;
+    int64_t remainder = ns % nsPerSecond;
+    if (remainder < 0)
+    {
+        seconds--;
+        remainder += nsPerSecond;
+    }
+    // remainder * 2^64 / 1e9 by long division in two 32 bit steps, exact and always below 2^64
+    // (a double rounds 999999999 ns up to 2^64, which doesn't fit the fraction)
+    auto scaled = static_cast<uint64_t>(remainder) << 32;
+    uint64_t high = scaled / nsPerSecond;
+    uint64_t low = ((scaled % nsPerSecond) << 32) / nsPerSecond;
+    return LVTimestamp{(high << 32) | low, seconds + lvEpochOffset};
+}
+
+static std::span<LVWaveformDBL> waveformsOf(LVVoid_t handle)
+{
+    auto waveforms = reinterpret_cast<LVWaveformDBLArrayHandle>(handle);
+    if (!waveforms || !*waveforms)
+    {
+        return {};
+    }
+    return {(*waveforms)->data(), static_cast<size_t>((*waveforms)->dims[0])};
+}
+
+// LabVIEW passes empty arrays as null handles
+static std::span<double> samplesOf(LVDblArrayHandle y)
+{
+    if (!y || !*y)
+    {
+        return {};
+    }
+    return {(*y)->data(), static_cast<size_t>((*y)->dims[0])};
+}
+
+// view of LabVIEW samples, a dummy base array sets ndarray.owndata to false
+static pybind11::array samplesView(std::vector<pybind11::ssize_t> shape, std::vector<pybind11::ssize_t> strides, double *data)
+{
+    return pybind11::array(pybind11::dtype::of<double>(), shape, strides, data, pybind11::array());
+}
+
+pybind11::object convertWaveformHandleToPythonObject(SessionHandle session, LVVoid_t handle, LVNumericType type)
+{
+    auto gepit = pybind11::module_::import("gepit");
+    auto numpy = pybind11::module_::import("numpy");
+    auto waveforms = waveformsOf(handle);
+
+    if (type == LVNumericType::DBL_WAVEFORM)
+    {
+        if (waveforms.empty())
+        {
+            throw std::out_of_range("A DBL_WAVEFORM argument is passed as a waveform array with one element.");
+        }
+        const auto &waveform = waveforms[0];
+        auto samples = samplesOf(waveform.Y);
+        auto y = samplesView({pybind11::ssize_t_cast(samples.size())}, {sizeof(double)}, samples.data());
+        return gepit.attr("Waveform")(numpy.attr("datetime64")(timestampToNs(waveform.t0), "ns"), waveform.dt, y);
+    }
+
+    size_t channels = waveforms.size();
+    size_t samples = channels ? samplesOf(waveforms[0].Y).size() : 0;
+    pybind11::array_t<int64_t> t0(pybind11::ssize_t_cast(channels));
+    pybind11::array_t<double> dt(pybind11::ssize_t_cast(channels));
+    auto t0Data = t0.mutable_data();
+    auto dtData = dt.mutable_data();
+
+    // LabVIEW allocates every channel separately, but if they happen to be evenly spaced Y can still be a view
+    auto first = reinterpret_cast<uint8_t *>(channels ? samplesOf(waveforms[0].Y).data() : nullptr);
+    auto stride = static_cast<ptrdiff_t>(samples * sizeof(double));
+    bool evenlySpaced = samples > 0;
+    for (size_t c = 0; c < channels; c++)
+    {
+        auto y = samplesOf(waveforms[c].Y);
+        if (y.size() != samples)
+        {
+            throw std::invalid_argument("The waveforms of a DBL_WAVEFORM_ARRAY must all have the same number of samples (channel " + std::to_string(c) + " has " + std::to_string(y.size()) + " rather than " + std::to_string(samples) + ").");
+        }
+        t0Data[c] = timestampToNs(waveforms[c].t0);
+        dtData[c] = waveforms[c].dt;
+        auto offset = reinterpret_cast<uint8_t *>(y.data()) - first;
+        if (c == 1)
+        {
+            stride = offset;
+        }
+        evenlySpaced = evenlySpaced && offset == static_cast<ptrdiff_t>(c) * stride;
+    }
+    evenlySpaced = evenlySpaced && stride % static_cast<ptrdiff_t>(sizeof(double)) == 0 && stride >= static_cast<ptrdiff_t>(samples * sizeof(double));
+
+    pybind11::array y;
+    if (evenlySpaced)
+    {
+        y = samplesView({pybind11::ssize_t_cast(channels), pybind11::ssize_t_cast(samples)}, {stride, sizeof(double)}, reinterpret_cast<double *>(first));
+    }
+    else
+    {
+        y = session->pool->array(pybind11::dtype::of<double>(), {pybind11::ssize_t_cast(channels), pybind11::ssize_t_cast(samples)});
+        auto rows = static_cast<double *>(y.mutable_data());
+        for (size_t c = 0; c < channels && samples > 0; c++)
+        {
+            std::memcpy(rows + c * samples, samplesOf(waveforms[c].Y).data(), samples * sizeof(double));
+        }
+    }
+    return gepit.attr("WaveformArray")(t0.attr("view")("datetime64[ns]"), dt, y);
+}
+
+pybind11::object copyWaveforms(pybind11::handle waveforms)
+{
+    return pybind11::module_::import("copy").attr("deepcopy")(waveforms);
+}
+
+void writeWaveformsToLVHandlePtr(pybind11::handle obj, LVVoid_t *handlePtr)
+{
+    auto numpy = pybind11::module_::import("numpy");
+    auto y = pybind11::array_t<double, pybind11::array::c_style | pybind11::array::forcecast>::ensure(asArrayLike(obj.attr("Y")));
+    if (!y || y.ndim() < 1 || y.ndim() > 2)
+    {
+        throw std::invalid_argument("The Y of a waveform must be a 1-D (one waveform) or 2-D (one per row) array of numbers.");
+    }
+    size_t channels = y.ndim() == 2 ? static_cast<size_t>(y.shape(0)) : 1;
+    size_t samples = static_cast<size_t>(y.shape(y.ndim() - 1));
+
+    auto waveforms = waveformsOf(*handlePtr);
+    if (waveforms.size() != channels)
+    {
+        throw std::length_error("The LabVIEW waveform array has " + std::to_string(waveforms.size()) + " elements but the Python waveforms have " + std::to_string(channels) + " channels, initialize it with one element per channel.");
+    }
+
+    // scalars apply to every channel, broadcasting also checks that vectors have one value per channel
+    auto channelCount = pybind11::ssize_t_cast(channels);
+    auto t0 = pybind11::array_t<int64_t>::ensure(numpy.attr("broadcast_to")(numpy.attr("asarray")(obj.attr("t0"), "datetime64[ns]"), channelCount).attr("view")("int64"));
+    auto dt = pybind11::array_t<double>::ensure(numpy.attr("broadcast_to")(obj.attr("dt"), channelCount));
+    if (!t0 || !dt)
+    {
+        throw std::invalid_argument("The t0 and dt of a waveform must be a datetime and a number, or one of each per channel.");
+    }
+    auto t0Values = t0.unchecked<1>();
+    auto dtValues = dt.unchecked<1>();
+
+    for (size_t c = 0; c < channels; c++)
+    {
+        auto &waveform = waveforms[c];
+        waveform.t0 = nsToTimestamp(t0Values(c));
+        waveform.dt = dtValues(c);
+        std::array<pybind11::ssize_t, 1> shape{pybind11::ssize_t_cast(samples)};
+        void *data = resizeLVArrayHandlePtr(LVTypeInfo{LVNumericType::DBL_ARRAY, 1}, reinterpret_cast<LVVoid_t *>(&waveform.Y), shape);
+        std::memcpy(data, y.data() + c * samples, samples * sizeof(double));
+    }
+}
+
+// python side: gepit.Waveform and gepit.WaveformArray
+void bind_waveform(pybind11::module_ &m)
+{
+    auto namedtuple = pybind11::module_::import("collections").attr("namedtuple");
+    auto fields = pybind11::make_tuple("t0", "dt", "Y");
+    m.attr("Waveform") = namedtuple("Waveform", fields, pybind11::arg("module") = "gepit");
+    m.attr("WaveformArray") = namedtuple("WaveformArray", fields, pybind11::arg("module") = "gepit");
+}
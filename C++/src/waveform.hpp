@@ -0,0 +1,23 @@
+#pragma once
+
+#include <gepit/gepit.hpp>
+
+inline bool lvIsWaveformType(LVNumericType type)
+{
+    return type == LVNumericType::DBL_WAVEFORM || type == LVNumericType::DBL_WAVEFORM_ARRAY;
+}
+
+// gepit.Waveform(t0, dt, Y) for DBL_WAVEFORM: Y is a view of the LabVIEW samples, t0 a numpy.datetime64 (ns, UTC)
+// gepit.WaveformArray(t0, dt, Y) for DBL_WAVEFORM_ARRAY: Y is (channels, samples), t0 and dt are per channel
+// Y is only a view of LabVIEW memory when the channels happen to be evenly spaced, otherwise it is assembled into pooled memory
+pybind11::object convertWaveformHandleToPythonObject(SessionHandle session, LVVoid_t handle, LVNumericType type);
+
+// the same waveform(s) with copies of their arrays, for values that outlive the DLL call
+pybind11::object copyWaveforms(pybind11::handle waveforms);
+
+// write anything with t0, dt and Y attributes into the waveforms of a LabVIEW waveform array
+// a 1-D Y is one waveform, a 2-D Y one per row; t0 and dt are scalars or one per row
+// LabVIEW sizes the waveform array (one element per channel), the Y arrays are resized here
+void writeWaveformsToLVHandlePtr(pybind11::handle obj, LVVoid_t *handlePtr);
+
+void bind_waveform(pybind11::module_ &m);
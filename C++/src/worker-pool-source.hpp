@@ -0,0 +1,382 @@
+#pragma once
+
+// python side of the worker pool, executed as the gepit.workers module the first time a pool is created
+// workers are plain python.exe processes running WORKER_SOURCE, so a crash in an extension only takes out the worker
+// control messages are pickled over a local socket, array arguments and results go through named shared memory
+// (windows file mappings, opened with mmap tagname like multiprocessing.shared_memory does)
+// MSVC limits a single string literal to 16380 bytes, so the source is split into adjacent literals
+constexpr const char *workerPoolSource = R"PY(
+import itertools
+import mmap
+import os
+import queue
+import secrets
+import socket
+import subprocess
+import sys
+import threading
+import weakref
+from multiprocessing import connection
+
+import numpy as np
+
+WORKER_SOURCE = r'''
+import mmap, sys, traceback, weakref
+from multiprocessing.connection import Client
+import numpy as np
+
+def main(host, port, prefix):
+    # the key comes over stdin, other processes can read the command line
+    authkey = bytes.fromhex(sys.stdin.readline().strip())
+    sys.stdin.close()
+    conn = Client((host, int(port)), authkey=authkey)
+    scope = {"__name__": "__gepit_worker__"}
+    objects = {}
+    results = {}
+    ids = iter(range(1, 2**62))
+    names = iter(range(1, 2**62))
+    arena = None
+
+    def unpack(arg, views):
+        kind = arg[0]
+        if kind == "val":
+            return arg[1]
+        if kind == "arr":
+            _, offset, shape, dtype = arg
+            count = int(np.prod(shape))
+            view = np.frombuffer(arena, dtype, count, offset)
+            views.append(weakref.ref(view))
+            return view.reshape(shape)
+        if kind == "ref":
+            return objects[arg[1]]
+        raise ValueError(kind)
+
+    def pack(value):
+        if value is None or isinstance(value, (bool, int, float, complex, str, bytes)):
+            return ("val", value)
+        if isinstance(value, np.ndarray) and not value.dtype.hasobject:
+            name = f"{prefix}_r{next(names)}"
+            segment = mmap.mmap(-1, max(value.nbytes, 1), tagname=name)
+            np.frombuffer(segment, value.dtype, value.size).reshape(value.shape)[...] = value
+            results[name] = segment
+            return ("arr", name, value.shape, value.dtype.str)
+        key = next(ids)
+        objects[key] = value
+        return ("ref", key)
+
+    while True:
+        try:
+            message = conn.recv()
+        except EOFError:
+            return
+        op, releases, drops = message[:3]
+        payload = message[3:]
+        for name in releases:
+            segment = results.pop(name, None)
+            if segment is not None:
+                segment.close()
+        for key in drops:
+            objects.pop(key, None)
+        views = []
+        try:
+            if op == "arena":
+                # argument views kept from earlier calls still map the old arena, it is unmapped once they are gone
+                arena = mmap.mmap(-1, payload[1], tagname=payload[0])
+                reply = ("val", None)
+            elif op == "exec":
+                exec(payload[0], scope)
+                reply = ("val", None)
+            elif op == "eval":
+                reply = pack(eval(payload[0], scope))
+            elif op == "call":
+                name, instance, args = payload
+                target = scope[name] if instance is None else getattr(objects[instance], name)
+                reply = pack(target(*[unpack(arg, views) for arg in args]))
+            elif op == "fetch":
+                reply = ("val", objects[payload[0]])
+            elif op == "stop":
+                conn.send(("ok", ("val", None), False))
+                return
+            else:
+                raise ValueError(f"unknown request {op}")
+            status = "ok"
+        except BaseException as e:
+            status, reply = "error", (type(e).__name__, str(e), traceback.format_exc())
+            # the traceback's frames would keep the arguments alive
+            traceback.clear_frames(e.__traceback__)
+        # an argument kept past the call (MovingAverager's window...) must not be overwritten by the next one,
+        # so the parent moves on to a new arena and this one stays mapped for as long as the argument lives
+        retained = any(view() is not None for view in views)
+        conn.send((status, reply, retained))
+
+main(*sys.argv[1:])
+'''
+)PY"
+                                         R"PY(
+_segment_names = itertools.count(1)
+
+
+class WorkerError(RuntimeError):
+    """An exception raised by code running in a worker process"""
+
+
+class WorkerCrashed(RuntimeError):
+    """The worker process exited while handling a request, it has been restarted"""
+
+
+class WorkerRef:
+    """Proxy for an object that lives in a worker process"""
+
+    __slots__ = ("worker", "generation", "id")
+
+    def __init__(self, worker, generation, id):
+        self.worker = worker
+        self.generation = generation
+        self.id = id
+
+    def __repr__(self):
+        return f"<gepit.workers.WorkerRef worker={self.worker.index} id={self.id}>"
+
+    def __del__(self):
+        # sent along with the next request to the worker
+        if self.worker.generation == self.generation:
+            self.worker.pending_drops.append(self.id)
+
+
+class _Worker:
+    def __init__(self, pool, index):
+        self.pool = pool
+        self.index = index
+        self.lock = threading.Lock()
+        self.generation = 0
+        self.restarts = 0
+        self.calls = 0
+        self.pending_drops = []
+        self.pending_releases = []
+        self.arena = None
+        self.arena_size = 0
+        self.arena_retained = False
+        self.process = None
+        self.conn = None
+        self._start()
+
+    def _start(self):
+        server = socket.create_server(("127.0.0.1", 0))
+        server.settimeout(self.pool.start_timeout)
+        host, port = server.getsockname()[:2]
+        prefix = f"gepit_{os.getpid()}_{self.index}_{self.generation}_{secrets.token_hex(4)}"
+        try:
+            self.process = subprocess.Popen(
+                [self.pool.python, "-c", WORKER_SOURCE, host, str(port), prefix],
+                stdin=subprocess.PIPE, creationflags=getattr(subprocess, "CREATE_NO_WINDOW", 0))
+            self.process.stdin.write(self.pool.authkey.hex().encode() + b"\n")
+            self.process.stdin.close()
+            sock, _ = server.accept()
+        finally:
+            server.close()
+        sock.settimeout(None)
+        self.conn = connection.Connection(sock.detach())
+        # the same handshake as multiprocessing.connection.Listener.accept
+        connection.deliver_challenge(self.conn, self.pool.authkey)
+        connection.answer_challenge(self.conn, self.pool.authkey)
+        self.arena = None
+        self.arena_size = 0
+        self.arena_retained = False
+        for source in self.pool.setup:
+            self._send("exec", source)
+
+    def _restart(self):
+        if self.process is not None and self.process.poll() is None:
+            self.process.kill()
+        if self.conn is not None:
+            self.conn.close()
+        self.generation += 1
+        self.restarts += 1
+        self.pending_drops = []
+        self.pending_releases = []
+        self._start()
+
+    def _send(self, op, *payload):
+        drops, self.pending_drops = self.pending_drops, []
+        releases, self.pending_releases = self.pending_releases, []
+        self.conn.send((op, releases, drops) + payload)
+        status, value, retained = self.conn.recv()
+        self.calls += 1
+        if retained:
+            self.arena_retained = True
+        if status == "error":
+            raise WorkerError(f"{value[0]}: {value[1]}\n{value[2]}")
+        return value
+
+    def request(self, op, *payload):
+        """send a request (caller holds self.lock), restarting the worker if it has died"""
+        if self.process.poll() is not None:
+            self._restart()
+        try:
+            return self._send(op, *payload)
+        except (EOFError, OSError) as e:
+            self._restart()
+            raise WorkerCrashed(f"worker {self.index} exited during a {op} request and has been restarted") from e
+
+    def ensure_arena(self, size):
+        if size <= self.arena_size and not self.arena_retained:
+            return
+        # a worker which keeps its arguments gets a segment per call, sized to fit
+        if not self.arena_retained:
+            size = max(size, 2 * self.arena_size, 1 << 20)
+        name = f"gepit_{os.getpid()}_{self.index}_a{next(_segment_names)}"
+        arena = mmap.mmap(-1, size, tagname=name)
+        self.request("arena", name, size)
+        if self.arena is not None:
+            self.arena.close()
+        self.arena, self.arena_size, self.arena_retained = arena, size, False
+
+    def unpack(self, reply):
+        kind = reply[0]
+        if kind == "val":
+            return reply[1]
+        if kind == "ref":
+            return WorkerRef(self, self.generation, reply[1])
+        _, name, shape, dtype = reply
+        dtype = np.dtype(dtype)
+        count = int(np.prod(shape))
+        segment = mmap.mmap(-1, max(count * dtype.itemsize, 1), tagname=name)
+        # the worker can unmap its side once the parent's last view of the segment is gone
+        weakref.finalize(segment, self._release, self.generation, name)
+        return np.frombuffer(segment, dtype, count).reshape(shape)
+
+    def _release(self, generation, name):
+        if generation == self.generation:
+            self.pending_releases.append(name)
+
+    def stop(self):
+        try:
+            with self.lock:
+                self._send("stop")
+        except Exception:
+            pass
+        if self.process is not None:
+            try:
+                self.process.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                self.process.kill()
+        if self.conn is not None:
+            self.conn.close()
+        if self.arena is not None:
+            self.arena.close()
+
+
+def _default_python():
+    name = "python.exe" if os.name == "nt" else "python3"
+    return os.path.join(sys.base_exec_prefix, name)
+
+
+class WorkerPool:
+    """Pool of python worker processes running code on behalf of a gepit session"""
+
+    def __init__(self, workers, python=None, start_timeout=60.0):
+        if workers < 1:
+            raise ValueError("a worker pool needs at least one worker")
+        self.python = python or _default_python()
+        self.start_timeout = start_timeout
+        self.authkey = secrets.token_bytes(32)
+        # code exec'd on every worker, replayed when a worker is restarted
+        self.setup = []
+        self.workers = []
+        self.idle = queue.SimpleQueue()
+        try:
+            for i in range(workers):
+                self.workers.append(_Worker(self, i))
+        except BaseException:
+            self.close()
+            raise
+        for worker in self.workers:
+            self.idle.put(worker)
+
+    def exec(self, source):
+        self.setup.append(source)
+        for worker in self.workers:
+            with worker.lock:
+                worker.request("exec", source)
+
+    def _pick(self, args, instance):
+        """the worker holding any proxies among the arguments, else the longest idle worker"""
+        owners = {a.worker for a in args if isinstance(a, WorkerRef)}
+        if isinstance(instance, WorkerRef):
+            owners.add(instance.worker)
+        if len(owners) > 1:
+            raise ValueError("objects from different workers can't be used in the same call")
+        if owners:
+            return owners.pop(), False
+        return self.idle.get(), True
+
+
+    def _pack(self, worker, args):
+        """array arguments are copied into the worker's shared arena, which the worker views in place
+        the arena is reused by the next call, unless the worker kept one of the views (see _send)"""
+        layout = []
+        size = 0
+        for arg in args:
+            if isinstance(arg, np.ndarray) and not arg.dtype.hasobject:
+                layout.append(size)
+                size += (arg.nbytes + 63) // 64 * 64
+            else:
+                layout.append(None)
+        if size:
+            worker.ensure_arena(size)
+        packed = []
+        for arg, offset in zip(args, layout):
+            if offset is not None:
+                np.frombuffer(worker.arena, arg.dtype, arg.size, offset).reshape(arg.shape)[...] = arg
+                packed.append(("arr", offset, arg.shape, arg.dtype.str))
+            elif isinstance(arg, WorkerRef):
+                if arg.generation != worker.generation:
+                    raise WorkerCrashed(f"the object lived in worker {worker.index}, which has been restarted since")
+                packed.append(("ref", arg.id))
+            else:
+                packed.append(("val", arg))
+        return packed
+
+    def call(self, name, instance, args):
+        args = list(args)
+        target = None
+        if isinstance(instance, WorkerRef):
+            target = instance.id
+        elif instance is not None:
+            raise TypeError("methods can only be called on objects that live in a worker")
+        worker, from_idle = self._pick(args, instance)
+        try:
+            with worker.lock:
+                return worker.unpack(worker.request("call", name, target, self._pack(worker, args)))
+        finally:
+            if from_idle:
+                self.idle.put(worker)
+
+    def eval(self, expression):
+        worker = self.idle.get()
+        try:
+            with worker.lock:
+                return worker.unpack(worker.request("eval", expression))
+        finally:
+            self.idle.put(worker)
+
+    def fetch(self, ref):
+        if not isinstance(ref, WorkerRef):
+            return ref
+        with ref.worker.lock:
+            if ref.generation != ref.worker.generation:
+                raise WorkerCrashed(f"the object lived in worker {ref.worker.index}, which has been restarted since")
+            return ref.worker.request("fetch", ref.id)[1]
+
+    def status(self):
+        return {
+            "workers": sum(w.process.poll() is None for w in self.workers),
+            "restarts": sum(w.restarts for w in self.workers),
+            "calls": sum(w.calls for w in self.workers),
+        }
+
+    def close(self):
+        for worker in self.workers:
+            worker.stop()
+        self.workers = []
+)PY";
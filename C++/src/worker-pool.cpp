@@ -0,0 +1,253 @@
+#include "call-function.hpp"
+#include "worker-pool-source.hpp"
+#include "worker-pool.hpp"
+
+WorkerPool::WorkerPool(pybind11::object pool) : pool(pool)
+{
+    // nothing else to construct
+}
+
+// gepit.workers, built from the embedded source the first time it is needed (GIL held)
+static pybind11::module_ workersModule()
+{
+    auto modules = pybind11::module_::import("sys").attr("modules").cast<pybind11::dict>();
+    if (modules.contains("gepit.workers"))
+    {
+        return modules["gepit.workers"].cast<pybind11::module_>();
+    }
+    auto gepit = pybind11::module_::import("gepit");
+    auto workers = pybind11::reinterpret_borrow<pybind11::module_>(pybind11::module_::import("types").attr("ModuleType")("gepit.workers"));
+    pybind11::exec(workerPoolSource, workers.attr("__dict__"));
+    modules["gepit.workers"] = workers;
+    gepit.attr("workers") = workers;
+    return workers;
+}
+
+int32_t create_worker_pool(LVErrorClusterPtr errorPtr, SessionHandle session, int32_t nWorkers, LVStrHandle pythonExecutableStrHandle, WorkerPoolHandlePtr workerPoolPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto python = lvStrHandleToStdString(pythonExecutableStrHandle);
+        // starting the workers waits on sockets, which releases the GIL
+        auto pool = workersModule().attr("WorkerPool")(nWorkers, python.empty() ? pybind11::none() : pybind11::str(python));
+        *workerPoolPtr = new WorkerPool(pool);
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t destroy_worker_pool(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!workerPool)
+    {
+        return writeInvalidWorkerPoolHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        // proxies still in the object store now refer to stopped workers and fail when used
+        workerPool->pool.attr("close")();
+        delete workerPool;
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+// run code on every worker, it is replayed on workers which are restarted after a crash
+int32_t worker_pool_exec_string(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVStrHandle stringHandle)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!workerPool)
+    {
+        return writeInvalidWorkerPoolHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        workerPool->pool.attr("exec")(lvStrHandleToPyStr(stringHandle));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t worker_pool_evaluate_string(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVStrHandle expressionHandle, LVPythonObjRef *returnObjectPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!workerPool)
+    {
+        return writeInvalidWorkerPoolHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        *returnObjectPtr = session->keepObject(workerPool->pool.attr("eval")(lvStrHandleToPyStr(expressionHandle)));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+// like call_function, classInstance and PYOBJ arguments may be proxies of objects living in a worker
+int32_t worker_pool_call_function(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVPythonObjRef classInstance, LVStrHandle fnNameStrHandle, LVArgumentClusterPtr argsPtr, LVArgumentTypeInfoHandle argTypesInfoHandle, LVPythonObjRef *returnObjectPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!workerPool)
+    {
+        return writeInvalidWorkerPoolHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        std::vector<pybind11::object> argObjects;
+        convertArgsToPythonObjects(session, argsPtr, argTypesInfoHandle, argObjects);
+        pybind11::tuple args(argObjects.size());
+        for (size_t i = 0; i < argObjects.size(); i++)
+        {
+            args[i] = std::move(argObjects[i]);
+        }
+        auto instance = session->isNullObject(classInstance) ? pybind11::none() : session->getObject(classInstance);
+        *returnObjectPtr = session->keepObject(workerPool->pool.attr("call")(lvStrHandleToPyStr(fnNameStrHandle), instance, args));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+// copy the value behind a proxy into the session (other objects are returned as they are)
+int32_t worker_pool_fetch(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, LVPythonObjRef object, LVPythonObjRef *returnObjectPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!workerPool)
+    {
+        return writeInvalidWorkerPoolHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        if (session->isNullObject(object))
+        {
+            return writeInvalidPythonObjectRefErr(errorPtr, __func__);
+        }
+        *returnObjectPtr = session->keepObject(workerPool->pool.attr("fetch")(session->getObject(object)));
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
+
+int32_t read_worker_pool_status(LVErrorClusterPtr errorPtr, SessionHandle session, WorkerPoolHandle workerPool, int32_t *aliveWorkersPtr, int32_t *restartsPtr, uint64_t *requestsPtr)
+{
+    if (!session)
+    {
+        return writeInvalidSessionHandleErr(errorPtr, __func__);
+    }
+    if (!workerPool)
+    {
+        return writeInvalidWorkerPoolHandleErr(errorPtr, __func__);
+    }
+    pybind11::gil_scoped_acquire gil;
+    try
+    {
+        auto status = workerPool->pool.attr("status")().cast<pybind11::dict>();
+        *aliveWorkersPtr = status["workers"].cast<int32_t>();
+        *restartsPtr = status["restarts"].cast<int32_t>();
+        *requestsPtr = status["calls"].cast<uint64_t>();
+    }
+    catch (pybind11::error_already_set const &e)
+    {
+        return writePythonExceptionErr(errorPtr, session, __func__, e);
+    }
+    catch (std::exception const &e)
+    {
+        return writeStdExceptionErr(errorPtr, __func__, e.what());
+    }
+    catch (...)
+    {
+        return writeUnkownErr(errorPtr, __func__);
+    }
+    return 0;
+}
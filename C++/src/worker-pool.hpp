@@ -0,0 +1,14 @@
+#pragma once
+
+#include <gepit/gepit.hpp>
+
+// a pool of out-of-process workers used through a session, see worker-pool-source.hpp
+// results that can't be sent back cheaply stay in the worker and are stored in the session as proxies
+class WorkerPool
+{
+public:
+    // gepit.workers.WorkerPool instance
+    const pybind11::object pool;
+
+    explicit WorkerPool(pybind11::object pool);
+};